@@ -0,0 +1,163 @@
+// Headless audio benchmark: plays the simulation's hit / damage events through
+// SoundPool on the null backend (cost of the game-side audio calls alone) and
+// on the offline WAV mixer (those calls plus software mixing). No sound device
+// needed. The two effects are synthesized, written as .wav files to the temp
+// directory and loaded back through the normal Load() path.
+//
+// usage: audio_benchmark [ticks] [enemies] [bullets] [out.wav]
+//   out.wav: also write the mixed audio of the run there
+
+#include "../src/world.h"
+#include "../src/sound_pool.h"
+#include "../src/wav_audio.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+// decaying sine, mono duplicated to stereo
+static std::vector<float> tone(float hz, float seconds, float decay)
+{
+    int frames = (int)(seconds * WavFileAudio::kSampleRate);
+    std::vector<float> out(frames * 2);
+    for (int f = 0; f < frames; ++f) {
+        float t = (float)f / WavFileAudio::kSampleRate;
+        out[f * 2] = out[f * 2 + 1] = 0.5f * std::sin(6.2831853f * hz * t) * std::exp(-decay * t);
+    }
+    return out;
+}
+
+// render one clip to a .wav through the backend itself
+static void writeClip(const std::string& path, const std::vector<float>& clip)
+{
+    WavFileAudio writer(path);
+    writer.Play(writer.LoadSamples(clip), 1.0f);
+    writer.Update((float)(clip.size() / 2) / WavFileAudio::kSampleRate + 0.001f);
+}
+
+// same as the game, see physically_based_bloom.cpp
+static const float kEffectVolume = 0.6f;
+
+// null backend that remembers the volume of the last Play()
+class VolumeProbe : public NullAudio
+{
+public:
+    float LastVolume = 0.0f;
+
+    int Play(int sound, float volume, bool looped = false) override
+    {
+        LastVolume = volume;
+        return NullAudio::Play(sound, volume, looped);
+    }
+};
+
+// a flush that coalesces several hits must play louder than a single hit
+static bool checkBurstVolume()
+{
+    VolumeProbe probe;
+    SoundPool pool;
+    pool.Init(&probe);
+    int hit = pool.Load("hit.wav", 4, kEffectVolume);
+
+    pool.Queue(hit, 1);
+    pool.Flush();
+    float single = probe.LastVolume;
+    pool.Queue(hit, 3);
+    pool.Flush();
+    float burst = probe.LastVolume;
+    pool.Destroy();
+
+    if (burst > single) return true;
+    std::printf("FAIL: 3-hit flush played at %.2f, single hit at %.2f\n", burst, single);
+    return false;
+}
+
+struct Result {
+    double poolNs = 0.0; // SoundPool Queue + Flush
+    double mixNs = 0.0;  // backend Update
+};
+
+static Result run(AudioBackend& audio, const std::vector<StepEvents>& events, float dt,
+                  const std::string& hitPath, const std::string& damagePath)
+{
+    SoundPool pool;
+    pool.Init(&audio);
+    int hit = pool.Load(hitPath, 4, kEffectVolume);
+    int damage = pool.Load(damagePath, 2, kEffectVolume);
+
+    Result r;
+    std::chrono::nanoseconds poolTime(0), mixTime(0);
+    for (const StepEvents& e : events) {
+        auto start = std::chrono::steady_clock::now();
+        pool.Queue(hit, e.enemiesHit);
+        pool.Queue(damage, e.playerHits);
+        pool.Flush();
+        auto flushed = std::chrono::steady_clock::now();
+        audio.Update(dt);
+        mixTime += std::chrono::steady_clock::now() - flushed;
+        poolTime += flushed - start;
+    }
+    pool.Destroy();
+    r.poolNs = (double)poolTime.count();
+    r.mixNs = (double)mixTime.count();
+    return r;
+}
+
+int main(int argc, char** argv)
+{
+    int ticks   = (argc > 1) ? std::atoi(argv[1]) : 36000;
+    int enemies = (argc > 2) ? std::atoi(argv[2]) : 200;
+    int bullets = (argc > 3) ? std::atoi(argv[3]) : 200;
+    std::string outPath = (argc > 4) ? argv[4] : "";
+    const float dt = 1.0f / 60.0f;
+
+    if (!checkBurstVolume())
+        return 1;
+
+    std::filesystem::path tmp = std::filesystem::temp_directory_path();
+    std::string hitPath = (tmp / "audio_benchmark_hit.wav").string();
+    std::string damagePath = (tmp / "audio_benchmark_damage.wav").string();
+    writeClip(hitPath, tone(880.0f, 0.15f, 25.0f));
+    writeClip(damagePath, tone(140.0f, 0.4f, 6.0f));
+
+    // record the event stream once so both backends see exactly the same load
+    World world(enemies, bullets + 64, 1234);
+    Pcg32 rng(5678);
+    PlayerInput input;
+    input.aim = glm::vec3(0.0f, 0.1f, -1.0f);
+    std::vector<StepEvents> events(ticks);
+    long totalEvents = 0;
+    for (int t = 0; t < ticks; ++t) {
+        while (world.Bullets.Size() < bullets) {
+            glm::vec3 pos(randomFloat(rng, -4.0f, 4.0f), randomFloat(rng, -1.0f, 4.0f), randomFloat(rng, -30.0f, 3.0f));
+            world.Bullets.Spawn(pos, glm::normalize(glm::vec3(0.0f, 0.1f, -1.0f)), 10.0f);
+        }
+        world.PlayerHealth = playerMaxHealth;
+        input.move.x = (t / 120) % 2 ? 1.0f : -1.0f;
+        events[t] = world.Step(dt, input);
+        totalEvents += events[t].enemiesHit + events[t].playerHits;
+    }
+    double seconds = ticks * dt;
+    std::printf("%d ticks (%.0f s of game time), %ld sound events\n", ticks, seconds, totalEvents);
+
+    NullAudio null;
+    Result n = run(null, events, dt, hitPath, damagePath);
+    std::printf("%-5s  pool %8.1f ns/event  %6.1f ns/tick   voices started %d\n", null.Name(),
+        n.poolNs / std::max(totalEvents, 1L), n.poolNs / ticks, null.Plays());
+
+    WavFileAudio wav(outPath);
+    Result w = run(wav, events, dt, hitPath, damagePath);
+    std::printf("%-5s  pool %8.1f ns/event  %6.1f ns/tick   mix %8.1f us per audio second (%.0fx realtime)  peak voices %d\n",
+        wav.Name(), w.poolNs / std::max(totalEvents, 1L), w.poolNs / ticks,
+        w.mixNs / 1000.0 / wav.SecondsMixed(), wav.SecondsMixed() * 1e9 / std::max(w.mixNs, 1.0), wav.PeakVoices());
+    if (!outPath.empty())
+        std::printf("wrote %.1f s to %s\n", wav.SecondsMixed(), outPath.c_str());
+
+    std::filesystem::remove(hitPath);
+    std::filesystem::remove(damagePath);
+    return 0;
+}
@@ -0,0 +1,93 @@
+// Bullet-vs-enemy collision benchmark: brute-force O(B*E) scan against the
+// SpatialHash broad-phase used by World, over a range of entity counts.
+//
+// usage: collision_benchmark [repeats]
+
+#include "../src/spatial_hash.h"
+#include "../src/world.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+static glm::vec3 randomPointInPlayfield(Pcg32& rng)
+{
+    return glm::vec3(randomFloat(rng, -5.0f, 5.0f), randomFloat(rng, -5.0f, 6.0f), randomFloat(rng, -30.0f, 3.0f));
+}
+
+// first enemy each bullet touches, -1 when none
+static int bruteForce(const std::vector<glm::vec3>& bullets, const std::vector<glm::vec3>& enemies, std::vector<int>& hits)
+{
+    const float r2 = kBulletHitRadius * kBulletHitRadius;
+    int count = 0;
+    for (size_t i = 0; i < bullets.size(); ++i) {
+        hits[i] = -1;
+        for (size_t j = 0; j < enemies.size(); ++j) {
+            glm::vec3 d = bullets[i] - enemies[j];
+            if (glm::dot(d, d) < r2) { hits[i] = (int)j; count++; break; }
+        }
+    }
+    return count;
+}
+
+static int spatialHash(SpatialHash& grid, const std::vector<glm::vec3>& bullets, const std::vector<glm::vec3>& enemies, std::vector<int>& hits)
+{
+    const float r2 = kBulletHitRadius * kBulletHitRadius;
+    grid.Clear();
+    for (size_t j = 0; j < enemies.size(); ++j)
+        grid.Insert((int)j, enemies[j]);
+    grid.Build();
+
+    int count = 0;
+    for (size_t i = 0; i < bullets.size(); ++i) {
+        int hit = -1;
+        const glm::vec3& p = bullets[i];
+        grid.ForEachNear(p, kBulletHitRadius, [&](int j) {
+            if (hit != -1 && j >= hit) return;
+            glm::vec3 d = p - enemies[j];
+            if (glm::dot(d, d) < r2) hit = j;
+        });
+        hits[i] = hit;
+        if (hit != -1) count++;
+    }
+    return count;
+}
+
+template <typename F>
+static double timeMs(int repeats, F&& f)
+{
+    auto start = std::chrono::steady_clock::now();
+    for (int r = 0; r < repeats; ++r) f();
+    std::chrono::duration<double, std::milli> ms = std::chrono::steady_clock::now() - start;
+    return ms.count() / repeats;
+}
+
+int main(int argc, char** argv)
+{
+    int repeats = (argc > 1) ? std::atoi(argv[1]) : 20;
+    const int sizes[][2] = { { 100, 10 }, { 1000, 100 }, { 5000, 500 }, { 10000, 1000 }, { 20000, 2000 } };
+
+    Pcg32 rng(1234);
+    SpatialHash grid(2.0f * kBulletHitRadius);
+
+    std::printf("%8s %8s %14s %14s %8s\n", "bullets", "enemies", "brute ms", "grid ms", "speedup");
+    for (const auto& size : sizes)
+    {
+        std::vector<glm::vec3> bullets(size[0]), enemies(size[1]);
+        for (glm::vec3& p : bullets) p = randomPointInPlayfield(rng);
+        for (glm::vec3& p : enemies) p = randomPointInPlayfield(rng);
+        std::vector<int> bruteHits(bullets.size()), gridHits(bullets.size());
+
+        int bruteCount = 0, gridCount = 0;
+        double bruteMs = timeMs(repeats, [&]() { bruteCount = bruteForce(bullets, enemies, bruteHits); });
+        double gridMs = timeMs(repeats, [&]() { gridCount = spatialHash(grid, bullets, enemies, gridHits); });
+
+        if (bruteHits != gridHits) {
+            std::fprintf(stderr, "mismatch at %d x %d: brute %d hits, grid %d hits\n", size[0], size[1], bruteCount, gridCount);
+            return 1;
+        }
+        std::printf("%8d %8d %14.3f %14.3f %7.1fx\n", size[0], size[1], bruteMs, gridMs, bruteMs / gridMs);
+    }
+    return 0;
+}
@@ -0,0 +1,134 @@
+// Headless replay: runs a recorded input log (game --record <file>) through
+// World and reports the cost per tick plus a checksum of the final state.
+// Every repeat must end in the same checksum; a different checksum between two
+// builds means the simulation changed behaviour.
+//
+// usage: replay_sim <file> [repeats] [threads]
+//        replay_sim --synthesize <file> [ticks] [seed]   (scripted session, no window needed)
+
+#include "../src/world.h"
+#include "../src/replay.h"
+#include "../src/mapped_file.h"
+#include "../src/job_system.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+static uint64_t stateChecksum(const World& world)
+{
+    std::vector<unsigned char> bytes;
+    auto add = [&bytes](const void* p, size_t n) {
+        bytes.insert(bytes.end(), (const unsigned char*)p, (const unsigned char*)p + n);
+    };
+    add(&world.PlayerPosition, sizeof(world.PlayerPosition));
+    add(&world.PlayerHealth, sizeof(world.PlayerHealth));
+    add(&world.PlayerScore, sizeof(world.PlayerScore));
+    for (int i = 0; i < world.Enemies.Size(); ++i) {
+        Enemy e = world.Enemies.Get(i);
+        add(&e.position, sizeof(e.position));
+        add(&e.state, sizeof(e.state));
+    }
+    const BulletPool* pools[] = { &world.Bullets, &world.EnemyBullets };
+    for (const BulletPool* pool : pools) {
+        for (int i = 0; i < pool->Size(); ++i) {
+            glm::vec3 p = pool->Position(i);
+            add(&p, sizeof(p));
+        }
+    }
+    return hashBytes(bytes.data(), bytes.size());
+}
+
+// a scripted "player": strafes, bobs and sweeps the aim, restarting on death
+static int synthesize(const char* path, int ticks, uint64_t seed)
+{
+    World world;
+    world.Seed(seed);
+    world.Reset();
+
+    InputRecorder recorder;
+    if (!recorder.Open(path, seed, world)) {
+        std::fprintf(stderr, "can't write %s\n", path);
+        return 1;
+    }
+
+    const float dt = 1.0f / 60.0f;
+    PlayerInput input;
+    for (int t = 0; t < ticks; ++t) {
+        input.move.x = (t / 90) % 2 ? 1.0f : -1.0f;
+        input.move.y = (t / 200) % 3 == 0 ? 1.0f : ((t / 200) % 3 == 1 ? -1.0f : 0.0f);
+        input.aim = glm::normalize(glm::vec3(0.3f * std::sin(t * 0.01f), 0.15f, -1.0f));
+
+        recorder.Step(dt, input);
+        world.Step(dt, input);
+        if (world.IsPlayerDead()) {
+            world.Reset();
+            recorder.Reset();
+        }
+    }
+    recorder.Close();
+    std::printf("wrote %d ticks to %s (seed %llu)  score %d  checksum %016llx\n", ticks, path,
+        (unsigned long long)seed, world.PlayerScore, (unsigned long long)stateChecksum(world));
+    return 0;
+}
+
+int main(int argc, char** argv)
+{
+    if (argc > 2 && std::strcmp(argv[1], "--synthesize") == 0) {
+        int ticks = (argc > 3) ? std::atoi(argv[3]) : 36000;
+        uint64_t seed = (argc > 4) ? std::strtoull(argv[4], nullptr, 10) : 1234;
+        return synthesize(argv[2], ticks, seed);
+    }
+    if (argc < 2) {
+        std::fprintf(stderr, "usage: replay_sim <file> [repeats] [threads]\n       replay_sim --synthesize <file> [ticks] [seed]\n");
+        return 1;
+    }
+    int repeats = (argc > 2) ? std::atoi(argv[2]) : 5;
+    // the checksum must not depend on this: parallel phases merge in index order
+    JobSystem jobs((argc > 3) ? (unsigned int)std::atoi(argv[3]) : 1u);
+
+    InputReplayer replay;
+    if (!replay.Open(argv[1])) {
+        std::fprintf(stderr, "can't read replay %s\n", argv[1]);
+        return 1;
+    }
+    const ReplayHeader& header = replay.Header();
+
+    uint64_t firstChecksum = 0;
+    for (int r = 0; r < repeats; ++r) {
+        World world(header.enemyCount, header.bulletCapacity);
+        replay.Setup(world);
+        if (jobs.Threads() > 1)
+            world.SetJobSystem(&jobs);
+        replay.Rewind();
+
+        int ticks = 0, resets = 0;
+        std::chrono::nanoseconds total(0);
+        ReplayTick tick;
+        while (replay.Next(tick)) {
+            if (tick.reset) {
+                world.Reset();
+                resets++;
+                continue;
+            }
+            auto start = std::chrono::steady_clock::now();
+            world.Step(tick.dt, tick.input);
+            total += std::chrono::steady_clock::now() - start;
+            ticks++;
+        }
+
+        uint64_t checksum = stateChecksum(world);
+        std::printf("run %d: ticks=%d resets=%d  %.1f ns/tick  score %d  checksum %016llx\n",
+            r, ticks, resets, (double)total.count() / (ticks > 0 ? ticks : 1), world.PlayerScore,
+            (unsigned long long)checksum);
+
+        if (r == 0) firstChecksum = checksum;
+        else if (checksum != firstChecksum) {
+            std::fprintf(stderr, "replay diverged on run %d\n", r);
+            return 1;
+        }
+    }
+    return 0;
+}
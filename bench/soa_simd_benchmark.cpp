@@ -0,0 +1,150 @@
+// Micro-benchmark: the per-entity loops World used to run over arrays of
+// structs (glm::vec3 + flags, std::sin per enemy, normalize per bullet) against
+// the structure-of-arrays SIMD kernels in simd_kernels.h that replace them.
+// Reports ns per entity for each kernel and checks both give the same answer.
+//
+// usage: soa_simd_benchmark [entities] [repeats]
+// build with -mavx2 to get the AVX2 kernels, otherwise SSE2 (or scalar off x86)
+
+#include "../src/simd_kernels.h"
+#include "../src/random.h"
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+struct AosEnemy {
+    glm::vec3 position;
+    glm::vec3 prevPosition;
+    glm::vec3 color;
+    bool alive;
+    int state;
+    float deathT;
+    float flashT;
+};
+
+struct AosBullet {
+    glm::vec3 position;
+    glm::vec3 prevPosition;
+    glm::vec3 direction;
+    float speed;
+};
+
+template <typename F>
+static double nsPerEntity(int entities, int repeats, F&& f)
+{
+    auto start = std::chrono::steady_clock::now();
+    for (int r = 0; r < repeats; ++r)
+        f();
+    std::chrono::duration<double, std::nano> ns = std::chrono::steady_clock::now() - start;
+    return ns.count() / ((double)entities * repeats);
+}
+
+static void report(const char* name, double aos, double soa, double maxError)
+{
+    std::printf("%-22s aos %6.2f ns  soa %6.2f ns  x%5.2f   max diff %.2g\n", name, aos, soa, aos / soa, maxError);
+}
+
+int main(int argc, char** argv)
+{
+    int n = (argc > 1) ? std::atoi(argv[1]) : 50000;
+    int repeats = (argc > 2) ? std::atoi(argv[2]) : 200;
+    const float dt = 1.0f / 60.0f;
+    const glm::vec3 step = glm::normalize(glm::vec3(0.0f, -0.3f, 1.0f)) * 2.5f * dt;
+    const glm::vec3 player(0.0f, -0.8f, 3.0f);
+    const float r2 = 0.7f * 0.7f;
+    std::printf("%d entities, %d repeats, %s kernels\n", n, repeats, simdInstructionSet());
+
+    Pcg32 rng(1234);
+    std::vector<AosEnemy> aosEnemies(n);
+    std::vector<AosBullet> aosBullets(n);
+    std::vector<float> ex(n), ey(n), ez(n), epx(n), epy(n), epz(n);
+    std::vector<float> bx(n), by(n), bz(n), bpx(n), bpy(n), bpz(n), bdx(n), bdy(n), bdz(n), bs(n);
+    for (int i = 0; i < n; ++i) {
+        glm::vec3 p(rng.Range(-5.0f, 5.0f), rng.Range(-5.0f, 6.0f), rng.Range(-30.0f, 3.0f));
+        aosEnemies[i].position = p;
+        aosEnemies[i].alive = true;
+        ex[i] = p.x; ey[i] = p.y; ez[i] = p.z;
+
+        glm::vec3 q(rng.Range(-5.0f, 5.0f), rng.Range(-5.0f, 6.0f), rng.Range(-30.0f, 3.0f));
+        glm::vec3 d = glm::normalize(glm::vec3(rng.Range(-1.0f, 1.0f), rng.Range(-1.0f, 1.0f), -1.0f));
+        aosBullets[i].position = q;
+        aosBullets[i].direction = d;
+        aosBullets[i].speed = 10.0f;
+        bx[i] = q.x; by[i] = q.y; bz[i] = q.z;
+        bdx[i] = d.x; bdy[i] = d.y; bdz[i] = d.z; bs[i] = 10.0f;
+    }
+    std::vector<uint8_t> aosFlags(n), soaFlags(n);
+    double time = 12.5; // sway phase
+
+    // ---- enemy integration + sine sway ----
+    // both sides start from the same positions and take the same number of steps
+    double aos = nsPerEntity(n, repeats, [&] {
+        for (AosEnemy& e : aosEnemies) {
+            e.prevPosition = e.position;
+            if (!e.alive) continue;
+            e.position += step;
+            e.position.x += (float)std::sin(time + e.position.z) * 0.002f;
+        }
+    });
+    float phase = (float)std::fmod(time, 6.283185307179586);
+    double soa = nsPerEntity(n, repeats, [&] {
+        integrateEnemies(ex.data(), ey.data(), ez.data(), epx.data(), epy.data(), epz.data(), 0, n, step, phase, 0.002f);
+    });
+    double err = 0.0;
+    for (int i = 0; i < n; ++i)
+        err = std::max(err, (double)glm::length(aosEnemies[i].position - glm::vec3(ex[i], ey[i], ez[i])));
+    report("enemy move + sway", aos, soa, err);
+
+    // ---- bullet integration ----
+    aos = nsPerEntity(n, repeats, [&] {
+        for (AosBullet& b : aosBullets) {
+            b.prevPosition = b.position;
+            b.position += glm::normalize(b.direction) * b.speed * dt;
+        }
+    });
+    soa = nsPerEntity(n, repeats, [&] {
+        integrateBullets(bx.data(), by.data(), bz.data(), bpx.data(), bpy.data(), bpz.data(),
+                         bdx.data(), bdy.data(), bdz.data(), bs.data(), 0, n, dt);
+    });
+    err = 0.0;
+    for (int i = 0; i < n; ++i)
+        err = std::max(err, (double)glm::length(aosBullets[i].position - glm::vec3(bx[i], by[i], bz[i])));
+    report("bullet move", aos, soa, err);
+
+    // ---- bounds culling ----
+    int aosCount = 0, soaCount = 0;
+    aos = nsPerEntity(n, repeats, [&] {
+        aosCount = 0;
+        for (int i = 0; i < n; ++i) {
+            float z = aosBullets[i].position.z;
+            aosFlags[i] = z > 0.0f || z < -20.0f;
+            aosCount += aosFlags[i];
+        }
+    });
+    soa = nsPerEntity(n, repeats, [&] {
+        soaCount = outsideRange(bz.data(), 0, n, -20.0f, 0.0f, soaFlags.data());
+    });
+    report("bounds cull", aos, soa, std::abs(aosCount - soaCount));
+
+    // ---- squared-distance test ----
+    aos = nsPerEntity(n, repeats, [&] {
+        aosCount = 0;
+        for (int i = 0; i < n; ++i) {
+            glm::vec3 d = aosEnemies[i].position - player;
+            aosFlags[i] = aosEnemies[i].alive && glm::dot(d, d) < r2;
+            aosCount += aosFlags[i];
+        }
+    });
+    soa = nsPerEntity(n, repeats, [&] {
+        soaCount = withinRadius(ex.data(), ey.data(), ez.data(), 0, n, player, r2, soaFlags.data());
+    });
+    report("squared distance", aos, soa, std::abs(aosCount - soaCount));
+
+    return 0;
+}
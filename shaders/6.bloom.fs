@@ -1,33 +1,42 @@
 #version 330 core
+// Specialized by #defines injected after the #version line (see cached_shader.h):
+//   TINT_ONLY    flat instance tint, no texture or lighting (bullets)
+//   NUM_LIGHTS   how many PerFrame lights to sum, set from the CPU's light count
+#ifndef NUM_LIGHTS
+#define NUM_LIGHTS 4
+#endif
 
 layout (location = 0) out vec4 FragColor;
-layout (location = 1) out vec4 BrightColor;
 
 in VS_OUT {
     vec3 FragPos;
     vec3 Normal;
     vec2 TexCoords;
+    vec3 Tint;
+    float Flash;
 } fs_in;
 
-struct Light {
-    vec3 Position;
-    vec3 Color;
+// per-frame camera/light data, see frame_uniforms.h
+layout (std140) uniform PerFrame {
+    mat4 projection;
+    mat4 view;
+    mat4 hudProjection;
+    vec4 viewPos;
+    vec4 lightPositions[4];
+    vec4 lightColors[4];
 };
 
-uniform Light lights[4];
 uniform sampler2D diffuseTexture;
-uniform vec3 viewPos;
-uniform vec3 enemyColor; 
-uniform float hitFlash; 
-uniform bool hasTexture;
-uniform bool useTintOnly;
 
 void main()
-{           
+{
+#ifdef TINT_ONLY
+    FragColor = vec4(fs_in.Tint, 1.0);
+#else
     // Sample the texture color
     vec3 color = texture(diffuseTexture, fs_in.TexCoords).rgb;
     // Multiply by the enemy's color
-    color *= enemyColor; // Apply the color change here
+    color *= fs_in.Tint; // Apply the color change here
 
     // Normalize the normal vector
     vec3 normal = normalize(fs_in.Normal);
@@ -37,17 +46,17 @@ void main()
     
     // Lighting calculations
     vec3 lighting = vec3(0.0);
-    vec3 viewDir = normalize(viewPos - fs_in.FragPos);
+    vec3 viewDir = normalize(viewPos.xyz - fs_in.FragPos);
     
-    for(int i = 0; i < 4; i++)
+    for(int i = 0; i < NUM_LIGHTS; i++)
     {
         // Diffuse lighting
-        vec3 lightDir = normalize(lights[i].Position - fs_in.FragPos);
+        vec3 lightDir = normalize(lightPositions[i].xyz - fs_in.FragPos);
         float diff = max(dot(lightDir, normal), 0.0);
-        vec3 result = lights[i].Color * diff * color;  // Apply color to lighting result
+        vec3 result = lightColors[i].rgb * diff * color;  // Apply color to lighting result
         
         // Attenuation based on distance (quadratic falloff)
-        float distance = length(fs_in.FragPos - lights[i].Position);
+        float distance = length(fs_in.FragPos - lightPositions[i].xyz);
         result *= 1.0 / (distance * distance);
  
         lighting += result;
@@ -56,20 +65,9 @@ void main()
     // Final result of ambient + lighting
     vec3 result = ambient + lighting;
     // Emissive flash so it gets bright (bloom will catch this)
-    result += enemyColor * hitFlash;
-    
-    if (useTintOnly) {
-        result = enemyColor;
-    }
-    
-    // Brightness check for bloom effect
-    float brightness = dot(result, vec3(0.2126, 0.7152, 0.0722));
-    if(brightness > 1.0)
-        BrightColor = vec4(result, 1.0);
-    else
-        BrightColor = vec4(0.0, 0.0, 0.0, 1.0);
+    result += fs_in.Tint * fs_in.Flash;
 
-   
-    // Final color output
+    // Final color output (bloom is extracted from this HDR value by the mip-chain downsample)
     FragColor = vec4(result, 1.0);
+#endif
 }
@@ -2,24 +2,40 @@
 layout (location = 0) in vec3 aPos;
 layout (location = 1) in vec3 aNormal;
 layout (location = 2) in vec2 aTexCoords;
+// per-instance attributes (see instancing.h); everything drawn with this shader is instanced
+layout (location = 7) in mat4 aInstanceModel;
+layout (location = 11) in vec3 aInstanceColor;
+layout (location = 12) in float aInstanceFlash;
 
 out VS_OUT {
     vec3 FragPos;
     vec3 Normal;
     vec2 TexCoords;
+    vec3 Tint;
+    float Flash;
 } vs_out;
 
-uniform mat4 projection;
-uniform mat4 view;
-uniform mat4 model;
+// per-frame camera/light data, see frame_uniforms.h
+layout (std140) uniform PerFrame {
+    mat4 projection;
+    mat4 view;
+    mat4 hudProjection;
+    vec4 viewPos;
+    vec4 lightPositions[4];
+    vec4 lightColors[4];
+};
 
 void main()
 {
-    vs_out.FragPos = vec3(model * vec4(aPos, 1.0));   
+    mat4 M = aInstanceModel;
+    vs_out.Tint = aInstanceColor;
+    vs_out.Flash = aInstanceFlash;
+
+    vs_out.FragPos = vec3(M * vec4(aPos, 1.0));   
     vs_out.TexCoords = aTexCoords;
         
-    mat3 normalMatrix = transpose(inverse(mat3(model)));
+    mat3 normalMatrix = transpose(inverse(mat3(M)));
     vs_out.Normal = normalize(normalMatrix * aNormal);
     
-    gl_Position = projection * view * model * vec4(aPos, 1.0);
+    gl_Position = projection * view * M * vec4(aPos, 1.0);
 }
\ No newline at end of file
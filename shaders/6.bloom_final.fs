@@ -1,4 +1,8 @@
 #version 330 core
+// BLOOM_MODE (injected, see cached_shader.h): 1 no bloom, 2 additive, 3 physically based mix
+#ifndef BLOOM_MODE
+#define BLOOM_MODE 3
+#endif
 out vec4 FragColor;
 
 in vec2 TexCoords;
@@ -7,7 +11,6 @@ uniform sampler2D scene;
 uniform sampler2D bloomBlur;
 uniform float exposure;
 uniform float bloomStrength = 0.04f;
-uniform int programChoice;
 
 vec3 bloom_none()
 {
@@ -32,15 +35,13 @@ vec3 bloom_new()
 void main()
 {
     // to bloom or not to bloom
-    vec3 result = vec3(0.0);
-    switch (programChoice)
-    {
-    case 1: result = bloom_none(); break;
-    case 2: result = bloom_old(); break;
-    case 3: result = bloom_new(); break;
-    default:
-        result = bloom_none(); break;
-    }
+#if BLOOM_MODE == 2
+    vec3 result = bloom_old();
+#elif BLOOM_MODE == 3
+    vec3 result = bloom_new();
+#else
+    vec3 result = bloom_none();
+#endif
     // tone mapping
     result = vec3(1.0) - exp(-result * exposure);
     // also gamma correct while we're at it
@@ -0,0 +1,84 @@
+#version 330 core
+
+// 13-tap downsample from the Call of Duty: Advanced Warfare bloom (SIGGRAPH 2014).
+// srcTexture must be a float format with bilinear filtering and edge clamping.
+uniform sampler2D srcTexture;
+uniform vec2 srcResolution;
+uniform int mipLevel = 1;
+
+in vec2 TexCoords;
+layout (location = 0) out vec3 downsample;
+
+vec3 PowVec3(vec3 v, float p)
+{
+    return vec3(pow(v.x, p), pow(v.y, p), pow(v.z, p));
+}
+
+const float invGamma = 1.0 / 2.2;
+vec3 ToSRGB(vec3 v) { return PowVec3(v, invGamma); }
+
+float RGBToLuminance(vec3 col)
+{
+    return dot(col, vec3(0.2126, 0.7152, 0.0722));
+}
+
+// weights bright samples down so single hot pixels don't flicker ("fireflies")
+float KarisAverage(vec3 col)
+{
+    float luma = RGBToLuminance(ToSRGB(col)) * 0.25;
+    return 1.0 / (1.0 + luma);
+}
+
+void main()
+{
+    vec2 srcTexelSize = 1.0 / srcResolution;
+    float x = srcTexelSize.x;
+    float y = srcTexelSize.y;
+
+    // a - b - c
+    // - j - k -
+    // d - e - f
+    // - l - m -
+    // g - h - i
+    vec3 a = texture(srcTexture, vec2(TexCoords.x - 2*x, TexCoords.y + 2*y)).rgb;
+    vec3 b = texture(srcTexture, vec2(TexCoords.x,       TexCoords.y + 2*y)).rgb;
+    vec3 c = texture(srcTexture, vec2(TexCoords.x + 2*x, TexCoords.y + 2*y)).rgb;
+
+    vec3 d = texture(srcTexture, vec2(TexCoords.x - 2*x, TexCoords.y)).rgb;
+    vec3 e = texture(srcTexture, vec2(TexCoords.x,       TexCoords.y)).rgb;
+    vec3 f = texture(srcTexture, vec2(TexCoords.x + 2*x, TexCoords.y)).rgb;
+
+    vec3 g = texture(srcTexture, vec2(TexCoords.x - 2*x, TexCoords.y - 2*y)).rgb;
+    vec3 h = texture(srcTexture, vec2(TexCoords.x,       TexCoords.y - 2*y)).rgb;
+    vec3 i = texture(srcTexture, vec2(TexCoords.x + 2*x, TexCoords.y - 2*y)).rgb;
+
+    vec3 j = texture(srcTexture, vec2(TexCoords.x - x, TexCoords.y + y)).rgb;
+    vec3 k = texture(srcTexture, vec2(TexCoords.x + x, TexCoords.y + y)).rgb;
+    vec3 l = texture(srcTexture, vec2(TexCoords.x - x, TexCoords.y - y)).rgb;
+    vec3 m = texture(srcTexture, vec2(TexCoords.x + x, TexCoords.y - y)).rgb;
+
+    if (mipLevel == 0)
+    {
+        // first downsample: Karis average per 2x2 group
+        vec3 groups[5];
+        groups[0] = (a + b + d + e) * (0.125 / 4.0);
+        groups[1] = (b + c + e + f) * (0.125 / 4.0);
+        groups[2] = (d + e + g + h) * (0.125 / 4.0);
+        groups[3] = (e + f + h + i) * (0.125 / 4.0);
+        groups[4] = (j + k + l + m) * (0.5 / 4.0);
+        groups[0] *= KarisAverage(groups[0]);
+        groups[1] *= KarisAverage(groups[1]);
+        groups[2] *= KarisAverage(groups[2]);
+        groups[3] *= KarisAverage(groups[3]);
+        groups[4] *= KarisAverage(groups[4]);
+        downsample = groups[0] + groups[1] + groups[2] + groups[3] + groups[4];
+        downsample = max(downsample, 0.0001);
+    }
+    else
+    {
+        downsample = e * 0.125;
+        downsample += (a + c + g + i) * 0.03125;
+        downsample += (b + d + f + h) * 0.0625;
+        downsample += (j + k + l + m) * 0.125;
+    }
+}
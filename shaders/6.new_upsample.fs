@@ -0,0 +1,38 @@
+#version 330 core
+
+// 3x3 tent filter upsample, blended additively onto the next larger mip.
+// filterRadius is in texture coordinates.
+uniform sampler2D srcTexture;
+uniform float filterRadius;
+
+in vec2 TexCoords;
+layout (location = 0) out vec3 upsample;
+
+void main()
+{
+    float x = filterRadius;
+    float y = filterRadius;
+
+    // a - b - c
+    // d - e - f
+    // g - h - i
+    vec3 a = texture(srcTexture, vec2(TexCoords.x - x, TexCoords.y + y)).rgb;
+    vec3 b = texture(srcTexture, vec2(TexCoords.x,     TexCoords.y + y)).rgb;
+    vec3 c = texture(srcTexture, vec2(TexCoords.x + x, TexCoords.y + y)).rgb;
+
+    vec3 d = texture(srcTexture, vec2(TexCoords.x - x, TexCoords.y)).rgb;
+    vec3 e = texture(srcTexture, vec2(TexCoords.x,     TexCoords.y)).rgb;
+    vec3 f = texture(srcTexture, vec2(TexCoords.x + x, TexCoords.y)).rgb;
+
+    vec3 g = texture(srcTexture, vec2(TexCoords.x - x, TexCoords.y - y)).rgb;
+    vec3 h = texture(srcTexture, vec2(TexCoords.x,     TexCoords.y - y)).rgb;
+    vec3 i = texture(srcTexture, vec2(TexCoords.x + x, TexCoords.y - y)).rgb;
+
+    //  1   | 1 2 1 |
+    // -- * | 2 4 2 |
+    // 16   | 1 2 1 |
+    upsample = e * 4.0;
+    upsample += (b + d + f + h) * 2.0;
+    upsample += (a + c + g + i);
+    upsample *= 1.0 / 16.0;
+}
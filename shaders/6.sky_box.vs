@@ -3,8 +3,15 @@ layout (location = 0) in vec3 aPos;
 
 out vec3 TexCoords;
 
-uniform mat4 projection;
-uniform mat4 view;
+// per-frame camera data, see frame_uniforms.h
+layout (std140) uniform PerFrame {
+    mat4 projection;
+    mat4 view;
+    mat4 hudProjection;
+    vec4 viewPos;
+    vec4 lightPositions[4];
+    vec4 lightColors[4];
+};
 
 void main()
 {
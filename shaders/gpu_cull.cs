@@ -0,0 +1,65 @@
+#version 430 core
+// Frustum culls every entity, picks the UFO level of detail from its projected
+// size and appends the visible ones to the instance lists of the indirect
+// draw commands of its model (see gpu_driven.h).
+layout (local_size_x = 64) in;
+
+struct Entity {
+    mat4 model;
+    vec4 colorFlash;
+    uvec4 info;       // x = model id
+};
+
+struct ModelInfo {
+    vec4 bounds;       // model-space sphere: xyz center, w radius
+    uint firstCommand;
+    uint commandCount;
+    int next;          // coarser level to use below minPixels, -1 = none
+    float minPixels;
+};
+
+// glMultiDrawElementsIndirect layout
+struct Command {
+    uint count;
+    uint instanceCount;
+    uint firstIndex;
+    int baseVertex;
+    uint baseInstance;
+};
+
+layout (std430, binding = 0) readonly buffer Entities { Entity entities[]; };
+layout (std430, binding = 1) buffer Commands { Command commands[]; };
+layout (std430, binding = 2) writeonly buffer Visible { uint visible[]; };
+layout (std430, binding = 3) readonly buffer Models { ModelInfo models[]; };
+
+uniform uint entityCount;
+uniform vec4 frustumPlanes[6];  // world space, normals pointing in
+uniform vec4 eye;               // xyz camera position, w = viewport height / tan(fovY / 2)
+
+void main()
+{
+    uint i = gl_GlobalInvocationID.x;
+    if (i >= entityCount)
+        return;
+
+    mat4 M = entities[i].model;
+    ModelInfo model = models[entities[i].info.x];
+    vec4 bounds = model.bounds;
+    vec3 center = vec3(M * vec4(bounds.xyz, 1.0));
+    float scale = sqrt(max(dot(M[0].xyz, M[0].xyz), max(dot(M[1].xyz, M[1].xyz), dot(M[2].xyz, M[2].xyz))));
+    float radius = bounds.w * scale;
+
+    for (int p = 0; p < 6; p++)
+        if (dot(frustumPlanes[p].xyz, center) + frustumPlanes[p].w < -radius)
+            return;
+
+    float pixels = radius * eye.w / max(length(center - eye.xyz), 1e-3);
+    while (model.next >= 0 && pixels < model.minPixels)
+        model = models[model.next];
+
+    for (uint k = 0u; k < model.commandCount; k++) {
+        uint c = model.firstCommand + k;
+        uint slot = atomicAdd(commands[c].instanceCount, 1u);
+        visible[commands[c].baseInstance + slot] = i;
+    }
+}
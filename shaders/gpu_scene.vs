@@ -0,0 +1,48 @@
+#version 430 core
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec3 aNormal;
+layout (location = 2) in vec2 aTexCoords;
+// index into Entities, one per instance: the visible list written by gpu_cull.cs,
+// offset by each indirect command's baseInstance
+layout (location = 7) in uint aEntity;
+
+out VS_OUT {
+    vec3 FragPos;
+    vec3 Normal;
+    vec2 TexCoords;
+    vec3 Tint;
+    float Flash;
+} vs_out;
+
+// per-frame camera/light data, see frame_uniforms.h
+layout (std140) uniform PerFrame {
+    mat4 projection;
+    mat4 view;
+    mat4 hudProjection;
+    vec4 viewPos;
+    vec4 lightPositions[4];
+    vec4 lightColors[4];
+};
+
+struct Entity {
+    mat4 model;
+    vec4 colorFlash;
+    uvec4 info;
+};
+
+layout (std430, binding = 0) readonly buffer Entities { Entity entities[]; };
+
+void main()
+{
+    mat4 M = entities[aEntity].model;
+    vs_out.Tint = entities[aEntity].colorFlash.rgb;
+    vs_out.Flash = entities[aEntity].colorFlash.a;
+
+    vs_out.FragPos = vec3(M * vec4(aPos, 1.0));
+    vs_out.TexCoords = aTexCoords;
+
+    mat3 normalMatrix = transpose(inverse(mat3(M)));
+    vs_out.Normal = normalize(normalMatrix * aNormal);
+
+    gl_Position = projection * view * M * vec4(aPos, 1.0);
+}
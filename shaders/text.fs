@@ -1,12 +1,12 @@
 #version 330 core
 in vec2 TexCoords;
+in vec3 TextColor;
 out vec4 FragColor;
 
-uniform sampler2D text;
-uniform vec3 textColor;
+uniform sampler2D text; // glyph atlas
 
 void main()
 {
     float alpha = texture(text, TexCoords).r;
-    FragColor = vec4(textColor, alpha);
+    FragColor = vec4(TextColor, alpha);
 }
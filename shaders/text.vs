@@ -1,11 +1,22 @@
 #version 330 core
 layout (location = 0) in vec4 vertex; // <vec2 pos, vec2 tex>
+layout (location = 1) in vec3 aColor;  // per-vertex so all strings batch into one draw
 out vec2 TexCoords;
+out vec3 TextColor;
 
-uniform mat4 projection;
+// per-frame data, see frame_uniforms.h; text uses the pixel-space hudProjection
+layout (std140) uniform PerFrame {
+    mat4 projection;
+    mat4 view;
+    mat4 hudProjection;
+    vec4 viewPos;
+    vec4 lightPositions[4];
+    vec4 lightColors[4];
+};
 
 void main()
 {
-    gl_Position = projection * vec4(vertex.xy, 0.0, 1.0);
+    gl_Position = hudProjection * vec4(vertex.xy, 0.0, 1.0);
     TexCoords = vertex.zw;
+    TextColor = aColor;
 }
@@ -0,0 +1,68 @@
+#ifndef AUDIO_H
+#define AUDIO_H
+
+#include <string>
+
+// Minimal audio output interface the game talks to, so the sound device is a
+// choice rather than a requirement:
+//   IrrKlangAudio  (audio_irrklang.h)  the real device
+//   NullAudio      (below)             discards everything, counts calls
+//   WavFileAudio   (wav_audio.h)       mixes in software and writes a .wav
+//
+// Sounds are loaded once and referred to by id; each Play() returns a voice id
+// that stays valid until the voice finishes or is stopped. Update() is called
+// once per frame with the elapsed time; backends that render offline produce
+// exactly that much audio.
+class AudioBackend
+{
+public:
+    virtual ~AudioBackend() {}
+
+    virtual const char* Name() const = 0;
+
+    // decode path (stream = play long files from disk); returns a sound id or -1
+    virtual int Load(const std::string& path, bool stream = false) = 0;
+
+    // returns a voice id, or -1 when sound is -1 or the voice couldn't start
+    virtual int Play(int sound, float volume, bool looped = false) = 0;
+
+    virtual bool IsPlaying(int voice) = 0;
+    virtual void Stop(int voice) = 0;
+
+    virtual void Update(float dt) = 0;
+};
+
+// Accepts and immediately forgets everything: voices finish as soon as they
+// start. For headless runs and for measuring the cost of the game's audio
+// calls without any mixing.
+class NullAudio : public AudioBackend
+{
+public:
+    NullAudio() : mLoads(0), mPlays(0) {}
+
+    const char* Name() const override { return "null"; }
+
+    int Load(const std::string&, bool = false) override
+    {
+        return mLoads++;
+    }
+
+    int Play(int sound, float, bool = false) override
+    {
+        if (sound < 0) return -1;
+        return mPlays++;
+    }
+
+    bool IsPlaying(int) override { return false; }
+    void Stop(int) override {}
+    void Update(float) override {}
+
+    int Loads() const { return mLoads; }
+    int Plays() const { return mPlays; }
+
+private:
+    int mLoads;
+    int mPlays;
+};
+
+#endif
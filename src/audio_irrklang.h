@@ -0,0 +1,88 @@
+#ifndef AUDIO_IRRKLANG_H
+#define AUDIO_IRRKLANG_H
+
+#include "audio.h"
+
+#include <irrKlang/irrKlang.h>
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// AudioBackend on an irrKlang device. irrKlang mixes on its own thread, so
+// Update() has nothing to do.
+class IrrKlangAudio : public AudioBackend
+{
+public:
+    IrrKlangAudio() : mEngine(nullptr), mNextVoice(0) {}
+
+    ~IrrKlangAudio()
+    {
+        for (auto& v : mVoices) {
+            v.second->stop();
+            v.second->drop();
+        }
+        if (mEngine) mEngine->drop();
+    }
+
+    // false when there is no usable sound device
+    bool Init()
+    {
+        mEngine = irrklang::createIrrKlangDevice();
+        return mEngine != nullptr;
+    }
+
+    const char* Name() const override { return "irrKlang"; }
+
+    int Load(const std::string& path, bool stream = false) override
+    {
+        if (!mEngine) return -1;
+        irrklang::ISoundSource* source = mEngine->addSoundSourceFromFile(path.c_str(),
+            stream ? irrklang::ESM_STREAMING : irrklang::ESM_NO_STREAMING, !stream);
+        if (!source) source = mEngine->getSoundSource(path.c_str(), false); // loaded before
+        if (!source) return -1;
+        mSources.push_back(source);
+        return (int)mSources.size() - 1;
+    }
+
+    int Play(int sound, float volume, bool looped = false) override
+    {
+        if (!mEngine || sound < 0) return -1;
+        // start paused so the volume is set before the first sample plays
+        irrklang::ISound* voice = mEngine->play2D(mSources[sound], looped, true, true);
+        if (!voice) return -1;
+        voice->setVolume(volume);
+        voice->setIsPaused(false);
+        mVoices[mNextVoice] = voice;
+        return mNextVoice++;
+    }
+
+    bool IsPlaying(int voice) override
+    {
+        auto it = mVoices.find(voice);
+        if (it == mVoices.end()) return false;
+        if (!it->second->isFinished()) return true;
+        it->second->drop();
+        mVoices.erase(it);
+        return false;
+    }
+
+    void Stop(int voice) override
+    {
+        auto it = mVoices.find(voice);
+        if (it == mVoices.end()) return;
+        it->second->stop();
+        it->second->drop();
+        mVoices.erase(it);
+    }
+
+    void Update(float) override {}
+
+private:
+    irrklang::ISoundEngine* mEngine;
+    std::vector<irrklang::ISoundSource*> mSources; // owned by the engine
+    std::unordered_map<int, irrklang::ISound*> mVoices;
+    int mNextVoice;
+};
+
+#endif
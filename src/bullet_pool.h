@@ -0,0 +1,109 @@
+#ifndef BULLET_POOL_H
+#define BULLET_POOL_H
+
+#include <glm/glm.hpp>
+
+#include "simd_kernels.h"
+
+#include <vector>
+
+struct Bullet {
+    glm::vec3 position;
+    glm::vec3 direction;
+    float speed;
+};
+
+const int kDefaultBulletCapacity = 4096;
+
+// Fixed-capacity bullet storage laid out as structure-of-arrays.
+// All storage is allocated up front, Spawn() is O(1) and never reallocates,
+// and Kill() is swap-and-pop, so bullet order is not preserved.
+// PrevX/Y/Z hold each bullet's position before the last Advance(), for
+// render-side interpolation between simulation ticks.
+class BulletPool
+{
+public:
+    std::vector<float> PosX, PosY, PosZ;
+    std::vector<float> PrevX, PrevY, PrevZ;
+    std::vector<float> DirX, DirY, DirZ;
+    std::vector<float> Speed;
+
+    BulletPool(int capacity = kDefaultBulletCapacity) : mCount(0), mCapacity(capacity)
+    {
+        PosX.resize(capacity); PosY.resize(capacity); PosZ.resize(capacity);
+        PrevX.resize(capacity); PrevY.resize(capacity); PrevZ.resize(capacity);
+        DirX.resize(capacity); DirY.resize(capacity); DirZ.resize(capacity);
+        Speed.resize(capacity);
+    }
+
+    int Size() const { return mCount; }
+    int Capacity() const { return mCapacity; }
+    bool Empty() const { return mCount == 0; }
+    bool Full() const { return mCount == mCapacity; }
+
+    void Clear()
+    {
+        mCount = 0;
+    }
+
+    // returns the new bullet's index, or -1 (and drops the shot) when the pool is full
+    int Spawn(const glm::vec3& position, const glm::vec3& direction, float speed)
+    {
+        if (mCount == mCapacity) return -1;
+        int i = mCount++;
+        PosX[i] = position.x; PosY[i] = position.y; PosZ[i] = position.z;
+        PrevX[i] = position.x; PrevY[i] = position.y; PrevZ[i] = position.z;
+        DirX[i] = direction.x; DirY[i] = direction.y; DirZ[i] = direction.z;
+        Speed[i] = speed;
+        return i;
+    }
+
+    // remove bullet i by moving the last bullet into its slot; when iterating,
+    // re-visit index i afterwards instead of advancing
+    void Kill(int i)
+    {
+        int last = --mCount;
+        if (i != last)
+        {
+            PosX[i] = PosX[last]; PosY[i] = PosY[last]; PosZ[i] = PosZ[last];
+            PrevX[i] = PrevX[last]; PrevY[i] = PrevY[last]; PrevZ[i] = PrevZ[last];
+            DirX[i] = DirX[last]; DirY[i] = DirY[last]; DirZ[i] = DirZ[last];
+            Speed[i] = Speed[last];
+        }
+    }
+
+    // move every bullet along its direction
+    void Advance(float dt)
+    {
+        Advance(0, mCount, dt);
+    }
+
+    // move bullets [begin, end) only, so disjoint ranges can advance in parallel
+    void Advance(int begin, int end, float dt)
+    {
+        integrateBullets(PosX.data(), PosY.data(), PosZ.data(), PrevX.data(), PrevY.data(), PrevZ.data(),
+                         DirX.data(), DirY.data(), DirZ.data(), Speed.data(), begin, end, dt);
+    }
+
+    glm::vec3 Position(int i) const { return glm::vec3(PosX[i], PosY[i], PosZ[i]); }
+    glm::vec3 Direction(int i) const { return glm::vec3(DirX[i], DirY[i], DirZ[i]); }
+    glm::vec3 PrevPosition(int i) const { return glm::vec3(PrevX[i], PrevY[i], PrevZ[i]); }
+
+    // position blended between the last two ticks, alpha in [0, 1]
+    glm::vec3 Interpolated(int i, float alpha) const { return glm::mix(PrevPosition(i), Position(i), alpha); }
+
+    Bullet Get(int i) const
+    {
+        Bullet b;
+        b.position = Position(i);
+        b.direction = Direction(i);
+        b.speed = Speed[i];
+        return b;
+    }
+
+private:
+    int mCount;
+    int mCapacity;
+};
+
+#endif
@@ -0,0 +1,189 @@
+#ifndef CACHED_SHADER_H
+#define CACHED_SHADER_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include "mapped_file.h"
+#include "program_cache.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// learnopengl's Shader with two caches: the setters look each uniform location
+// up once and remember it instead of asking the driver with
+// glGetUniformLocation on every call, and the linked program is restored from
+// "<vertex>+<fragment>.progbin" (see program_cache.h) when the sources and
+// driver match, so only the first launch compiles.
+//
+// defines ("NAME" or "NAME value") are injected after each stage's #version
+// line, which is how one source file is built into specialized permutations
+// (e.g. 6.bloom.fs with TINT_ONLY); every permutation is its own program and
+// cache file.
+class CachedShader
+{
+public:
+    unsigned int ID;
+
+    CachedShader(const char* vertexPath, const char* fragmentPath, const char* geometryPath = nullptr,
+                 const std::vector<std::string>& defines = {}) : ID(0)
+    {
+        std::string vertexCode = injectDefines(readSource(vertexPath), defines);
+        std::string fragmentCode = injectDefines(readSource(fragmentPath), defines);
+        std::string geometryCode = geometryPath ? injectDefines(readSource(geometryPath), defines) : std::string();
+
+        std::string sources = vertexCode + '\0' + fragmentCode + '\0' + geometryCode;
+        uint64_t sourceHash = hashBytes((const unsigned char*)sources.data(), sources.size());
+        std::string cachePath = std::string(vertexPath) + "+" + fragmentPath;
+        for (const std::string& define : defines) {
+            std::string name = define;
+            std::replace(name.begin(), name.end(), ' ', '=');
+            cachePath += "." + name;
+        }
+        cachePath += ".progbin";
+
+        ID = ProgramBinaryCache::Load(cachePath, sourceHash);
+        if (ID) return;
+        if (build(vertexCode, fragmentCode, geometryCode))
+            ProgramBinaryCache::Save(cachePath, sourceHash, ID);
+    }
+
+    void use() const
+    {
+        glUseProgram(ID);
+    }
+
+    GLint Location(const std::string& name) const
+    {
+        auto it = mLocations.find(name);
+        if (it != mLocations.end())
+            return it->second;
+        GLint location = glGetUniformLocation(ID, name.c_str());
+        mLocations.emplace(name, location);
+        return location;
+    }
+
+    void setBool(const std::string& name, bool value) const
+    {
+        glUniform1i(Location(name), (int)value);
+    }
+    void setInt(const std::string& name, int value) const
+    {
+        glUniform1i(Location(name), value);
+    }
+    void setFloat(const std::string& name, float value) const
+    {
+        glUniform1f(Location(name), value);
+    }
+    void setVec2(const std::string& name, const glm::vec2& value) const
+    {
+        glUniform2fv(Location(name), 1, &value[0]);
+    }
+    void setVec2(const std::string& name, float x, float y) const
+    {
+        glUniform2f(Location(name), x, y);
+    }
+    void setVec3(const std::string& name, const glm::vec3& value) const
+    {
+        glUniform3fv(Location(name), 1, &value[0]);
+    }
+    void setVec3(const std::string& name, float x, float y, float z) const
+    {
+        glUniform3f(Location(name), x, y, z);
+    }
+    void setVec4(const std::string& name, const glm::vec4& value) const
+    {
+        glUniform4fv(Location(name), 1, &value[0]);
+    }
+    void setMat3(const std::string& name, const glm::mat3& mat) const
+    {
+        glUniformMatrix3fv(Location(name), 1, GL_FALSE, &mat[0][0]);
+    }
+    void setMat4(const std::string& name, const glm::mat4& mat) const
+    {
+        glUniformMatrix4fv(Location(name), 1, GL_FALSE, &mat[0][0]);
+    }
+
+private:
+    mutable std::unordered_map<std::string, GLint> mLocations;
+
+    static std::string readSource(const char* path)
+    {
+        std::ifstream file(path);
+        if (!file) {
+            std::cout << "ERROR::SHADER::FILE_NOT_SUCCESSFULLY_READ: " << path << std::endl;
+            return std::string();
+        }
+        std::stringstream stream;
+        stream << file.rdbuf();
+        return stream.str();
+    }
+
+    // "#define ..." lines right after #version, then #line so compile errors
+    // still point at the file's own line numbers
+    static std::string injectDefines(const std::string& code, const std::vector<std::string>& defines)
+    {
+        if (defines.empty()) return code;
+        size_t version = code.find("#version");
+        size_t lineEnd = version == std::string::npos ? std::string::npos : code.find('\n', version);
+        if (lineEnd == std::string::npos) return code;
+
+        std::string block;
+        for (const std::string& define : defines)
+            block += "#define " + define + "\n";
+        int nextLine = 2 + (int)std::count(code.begin(), code.begin() + version, '\n');
+        block += "#line " + std::to_string(nextLine) + "\n";
+        return code.substr(0, lineEnd + 1) + block + code.substr(lineEnd + 1);
+    }
+
+    static unsigned int compile(GLenum type, const std::string& code, const char* typeName)
+    {
+        const char* source = code.c_str();
+        unsigned int shader = glCreateShader(type);
+        glShaderSource(shader, 1, &source, NULL);
+        glCompileShader(shader);
+        GLint ok = 0;
+        glGetShaderiv(shader, GL_COMPILE_STATUS, &ok);
+        if (!ok) {
+            char log[1024];
+            glGetShaderInfoLog(shader, sizeof(log), NULL, log);
+            std::cout << "ERROR::SHADER_COMPILATION_ERROR of type: " << typeName << "\n" << log << std::endl;
+        }
+        return shader;
+    }
+
+    // compile and link from source; true when the program linked
+    bool build(const std::string& vertexCode, const std::string& fragmentCode, const std::string& geometryCode)
+    {
+        unsigned int vertex = compile(GL_VERTEX_SHADER, vertexCode, "VERTEX");
+        unsigned int fragment = compile(GL_FRAGMENT_SHADER, fragmentCode, "FRAGMENT");
+        unsigned int geometry = geometryCode.empty() ? 0 : compile(GL_GEOMETRY_SHADER, geometryCode, "GEOMETRY");
+
+        ID = glCreateProgram();
+        ProgramBinaryCache::PrepareLink(ID);
+        glAttachShader(ID, vertex);
+        glAttachShader(ID, fragment);
+        if (geometry) glAttachShader(ID, geometry);
+        glLinkProgram(ID);
+        glDeleteShader(vertex);
+        glDeleteShader(fragment);
+        if (geometry) glDeleteShader(geometry);
+
+        GLint ok = 0;
+        glGetProgramiv(ID, GL_LINK_STATUS, &ok);
+        if (!ok) {
+            char log[1024];
+            glGetProgramInfoLog(ID, sizeof(log), NULL, log);
+            std::cout << "ERROR::PROGRAM_LINKING_ERROR of type: PROGRAM\n" << log << std::endl;
+        }
+        return ok != 0;
+    }
+};
+
+#endif
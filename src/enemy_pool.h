@@ -0,0 +1,81 @@
+#ifndef ENEMY_POOL_H
+#define ENEMY_POOL_H
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <vector>
+
+enum EnemyState { ENEMY_ALIVE, ENEMY_DYING, ENEMY_DEAD };
+
+// one enemy gathered out of the pool, for code that isn't on the hot path
+struct Enemy {
+    glm::vec3 position;
+    glm::vec3 prevPosition; // position at the start of the last Step(), for interpolation
+    glm::vec3 color;
+    bool alive = true;      // alive or still playing its death animation
+    EnemyState state = ENEMY_ALIVE;
+    float deathT = 0.0f;
+    float flashT = 0.0f;
+};
+
+// Fixed-size enemy storage laid out as structure-of-arrays, so the per-tick
+// movement and collision loops stream through plain float arrays (see
+// simd_kernels.h). Enemies are never removed, only respawned in place, so an
+// index stays the same enemy for the lifetime of the pool.
+class EnemyPool
+{
+public:
+    std::vector<float> PosX, PosY, PosZ;
+    std::vector<float> PrevX, PrevY, PrevZ;
+    std::vector<uint8_t> State; // EnemyState
+    std::vector<float> DeathT;
+    std::vector<float> FlashT;
+    std::vector<glm::vec3> Color;
+
+    EnemyPool(int count = 0)
+    {
+        Resize(count);
+    }
+
+    void Resize(int count)
+    {
+        PosX.resize(count); PosY.resize(count); PosZ.resize(count);
+        PrevX.resize(count); PrevY.resize(count); PrevZ.resize(count);
+        State.resize(count, ENEMY_ALIVE);
+        DeathT.resize(count);
+        FlashT.resize(count);
+        Color.resize(count);
+    }
+
+    int Size() const { return (int)State.size(); }
+
+    // alive or dying; only ENEMY_DEAD enemies are skipped by collisions and drawing
+    bool Alive(int i) const { return State[i] != ENEMY_DEAD; }
+
+    glm::vec3 Position(int i) const { return glm::vec3(PosX[i], PosY[i], PosZ[i]); }
+    glm::vec3 PrevPosition(int i) const { return glm::vec3(PrevX[i], PrevY[i], PrevZ[i]); }
+
+    // position blended between the last two ticks, alpha in [0, 1]
+    glm::vec3 Interpolated(int i, float alpha) const { return glm::mix(PrevPosition(i), Position(i), alpha); }
+
+    void SetPosition(int i, const glm::vec3& p)
+    {
+        PosX[i] = p.x; PosY[i] = p.y; PosZ[i] = p.z;
+    }
+
+    Enemy Get(int i) const
+    {
+        Enemy e;
+        e.position = Position(i);
+        e.prevPosition = PrevPosition(i);
+        e.color = Color[i];
+        e.state = (EnemyState)State[i];
+        e.alive = Alive(i);
+        e.deathT = DeathT[i];
+        e.flashT = FlashT[i];
+        return e;
+    }
+};
+
+#endif
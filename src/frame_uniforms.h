@@ -0,0 +1,70 @@
+#ifndef FRAME_UNIFORMS_H
+#define FRAME_UNIFORMS_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include "cached_shader.h"
+
+#include <iostream>
+
+const unsigned int kMaxLights = 4;
+// uniform buffer binding point shared by every program that declares the PerFrame block
+const unsigned int kPerFrameBinding = 0;
+
+// CPU mirror of the std140 'PerFrame' block in 6.bloom.*, 6.sky_box.vs and text.vs.
+// Only mat4/vec4 members, so the C++ layout matches std140 without padding.
+struct PerFrameUniforms {
+    glm::mat4 projection;
+    glm::mat4 view;
+    glm::mat4 hudProjection;              // pixel-space ortho for the HUD text
+    glm::vec4 viewPos;                    // xyz
+    glm::vec4 lightPositions[kMaxLights]; // xyz
+    glm::vec4 lightColors[kMaxLights];    // rgb, zero for unused lights
+};
+
+// one uniform buffer holding the per-frame camera/light data, uploaded once a frame
+// and bound to kPerFrameBinding for every program
+class PerFrameBuffer
+{
+public:
+    PerFrameBuffer() : mUBO(0) {}
+
+    void Init()
+    {
+        glGenBuffers(1, &mUBO);
+        glBindBuffer(GL_UNIFORM_BUFFER, mUBO);
+        glBufferData(GL_UNIFORM_BUFFER, sizeof(PerFrameUniforms), NULL, GL_DYNAMIC_DRAW);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+        glBindBufferBase(GL_UNIFORM_BUFFER, kPerFrameBinding, mUBO);
+    }
+
+    void Destroy()
+    {
+        glDeleteBuffers(1, &mUBO);
+        mUBO = 0;
+    }
+
+    void Update(const PerFrameUniforms& data)
+    {
+        glBindBuffer(GL_UNIFORM_BUFFER, mUBO);
+        glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(PerFrameUniforms), &data);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    }
+
+    // point a program's PerFrame block at the shared binding (GLSL 330 has no layout(binding))
+    static void Attach(const CachedShader& shader)
+    {
+        unsigned int index = glGetUniformBlockIndex(shader.ID, "PerFrame");
+        if (index == GL_INVALID_INDEX) {
+            std::cout << "PerFrame uniform block not found in program " << shader.ID << std::endl;
+            return;
+        }
+        glUniformBlockBinding(shader.ID, index, kPerFrameBinding);
+    }
+
+private:
+    unsigned int mUBO;
+};
+
+#endif
@@ -0,0 +1,68 @@
+#ifndef FRUSTUM_H
+#define FRUSTUM_H
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+struct BoundingSphere {
+    glm::vec3 center = glm::vec3(0.0f);
+    float radius = 0.0f;
+};
+
+// sphere in model space -> sphere under M (radius grows with the largest axis scale)
+inline BoundingSphere transformSphere(const BoundingSphere& s, const glm::mat4& M)
+{
+    float sx = glm::dot(glm::vec3(M[0]), glm::vec3(M[0]));
+    float sy = glm::dot(glm::vec3(M[1]), glm::vec3(M[1]));
+    float sz = glm::dot(glm::vec3(M[2]), glm::vec3(M[2]));
+    BoundingSphere out;
+    out.center = glm::vec3(M * glm::vec4(s.center, 1.0f));
+    out.radius = s.radius * std::sqrt(std::max(sx, std::max(sy, sz)));
+    return out;
+}
+
+// The six clip planes of a projection * view matrix (Gribb / Hartmann), in
+// world space with normals pointing inwards.
+class Frustum
+{
+public:
+    Frustum(const glm::mat4& viewProjection)
+    {
+        glm::mat4 m = glm::transpose(viewProjection); // rows of viewProjection
+        mPlanes[0] = m[3] + m[0]; // left
+        mPlanes[1] = m[3] - m[0]; // right
+        mPlanes[2] = m[3] + m[1]; // bottom
+        mPlanes[3] = m[3] - m[1]; // top
+        mPlanes[4] = m[3] + m[2]; // near
+        mPlanes[5] = m[3] - m[2]; // far
+        for (glm::vec4& p : mPlanes)
+            p /= glm::length(glm::vec3(p));
+    }
+
+    // false only when the sphere is entirely outside one plane
+    bool Intersects(const BoundingSphere& s) const
+    {
+        for (const glm::vec4& p : mPlanes)
+            if (glm::dot(glm::vec3(p), s.center) + p.w < -s.radius)
+                return false;
+        return true;
+    }
+
+    // left, right, bottom, top, near, far as (normal, distance)
+    const glm::vec4* Planes() const { return mPlanes; }
+
+private:
+    glm::vec4 mPlanes[6];
+};
+
+// on-screen diameter in pixels of a sphere seen from eye through a vertical
+// field of view of fovY radians onto a viewport viewportHeight pixels tall
+inline float projectedDiameter(const BoundingSphere& s, const glm::vec3& eye, float fovY, float viewportHeight)
+{
+    float distance = std::max(glm::length(s.center - eye), 1e-3f);
+    return s.radius * viewportHeight / (distance * std::tan(fovY * 0.5f));
+}
+
+#endif
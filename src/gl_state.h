@@ -0,0 +1,124 @@
+#ifndef GL_STATE_H
+#define GL_STATE_H
+
+#include <glad/glad.h>
+
+// Shadow copy of the GL state the scene passes change most: program, vertex
+// array, the texture bound per unit, blending and depth state. Each setter
+// only calls into GL when the value actually changes, and counts both the calls
+// it made and the ones it skipped.
+//
+// Code that binds things behind the cache's back (learnopengl's Mesh::Draw,
+// the bloom and text helpers) leaves it stale, so Invalidate() before relying
+// on it again; RenderQueue::Flush() does that on entry.
+class GLStateCache
+{
+public:
+    static const int kTextureUnits = 8;
+
+    GLStateCache()
+    {
+        Invalidate();
+        ResetCounters();
+    }
+
+    // forget everything: the next call of each setter goes through
+    void Invalidate()
+    {
+        mProgram = kUnknown;
+        mVertexArray = kUnknown;
+        mActiveUnit = kUnknown;
+        for (int i = 0; i < kTextureUnits; i++) {
+            mTexture2D[i] = kUnknown;
+            mTextureCube[i] = kUnknown;
+        }
+        mBlend = mDepthTest = mDepthMask = -1;
+        mDepthFunc = kUnknown;
+    }
+
+    void UseProgram(unsigned int program)
+    {
+        if (skip(mProgram == program)) return;
+        mProgram = program;
+        glUseProgram(program);
+    }
+
+    void BindVertexArray(unsigned int vao)
+    {
+        if (skip(mVertexArray == vao)) return;
+        mVertexArray = vao;
+        glBindVertexArray(vao);
+    }
+
+    // target is GL_TEXTURE_2D or GL_TEXTURE_CUBE_MAP
+    void BindTexture(int unit, GLenum target, unsigned int texture)
+    {
+        unsigned int& bound = (target == GL_TEXTURE_CUBE_MAP) ? mTextureCube[unit] : mTexture2D[unit];
+        if (skip(bound == texture)) return;
+        bound = texture;
+        if (mActiveUnit != (unsigned int)unit) {
+            mActiveUnit = unit;
+            glActiveTexture(GL_TEXTURE0 + unit);
+        }
+        glBindTexture(target, texture);
+    }
+
+    void SetBlend(bool enabled)
+    {
+        if (skip(mBlend == (int)enabled)) return;
+        mBlend = enabled;
+        if (enabled) glEnable(GL_BLEND); else glDisable(GL_BLEND);
+    }
+
+    void SetDepthTest(bool enabled)
+    {
+        if (skip(mDepthTest == (int)enabled)) return;
+        mDepthTest = enabled;
+        if (enabled) glEnable(GL_DEPTH_TEST); else glDisable(GL_DEPTH_TEST);
+    }
+
+    void SetDepthMask(bool write)
+    {
+        if (skip(mDepthMask == (int)write)) return;
+        mDepthMask = write;
+        glDepthMask(write ? GL_TRUE : GL_FALSE);
+    }
+
+    void SetDepthFunc(GLenum func)
+    {
+        if (skip(mDepthFunc == func)) return;
+        mDepthFunc = func;
+        glDepthFunc(func);
+    }
+
+    // calls made / skipped since ResetCounters(), e.g. per frame
+    int Issued() const { return mIssued; }
+    int Saved() const { return mSaved; }
+
+    void ResetCounters()
+    {
+        mIssued = 0;
+        mSaved = 0;
+    }
+
+private:
+    static const unsigned int kUnknown = 0xFFFFFFFFu; // never a valid GL name
+
+    unsigned int mProgram;
+    unsigned int mVertexArray;
+    unsigned int mActiveUnit;
+    unsigned int mTexture2D[kTextureUnits];
+    unsigned int mTextureCube[kTextureUnits];
+    int mBlend, mDepthTest, mDepthMask; // -1 = unknown
+    GLenum mDepthFunc;
+    int mIssued;
+    int mSaved;
+
+    bool skip(bool redundant)
+    {
+        if (redundant) mSaved++; else mIssued++;
+        return redundant;
+    }
+};
+
+#endif
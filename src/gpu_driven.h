@@ -0,0 +1,392 @@
+#ifndef GPU_DRIVEN_H
+#define GPU_DRIVEN_H
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <glm/glm.hpp>
+
+#include <learnopengl/shader.h>
+#include <learnopengl/model.h>
+
+#include "cached_shader.h"
+#include "frustum.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#ifndef GL_SHADER_STORAGE_BUFFER
+#define GL_SHADER_STORAGE_BUFFER 0x90D2
+#endif
+#ifndef GL_DRAW_INDIRECT_BUFFER
+#define GL_DRAW_INDIRECT_BUFFER 0x8F3F
+#endif
+#ifndef GL_COMPUTE_SHADER
+#define GL_COMPUTE_SHADER 0x91B9
+#endif
+#ifndef GL_SHADER_STORAGE_BARRIER_BIT
+#define GL_SHADER_STORAGE_BARRIER_BIT 0x00002000
+#endif
+#ifndef GL_COMMAND_BARRIER_BIT
+#define GL_COMMAND_BARRIER_BIT 0x00000040
+#endif
+#ifndef GL_MAX_VERTEX_SHADER_STORAGE_BLOCKS
+#define GL_MAX_VERTEX_SHADER_STORAGE_BLOCKS 0x90D6
+#endif
+#ifndef GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT
+#define GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT 0x00000001
+#endif
+
+// One entity for gpu_cull.cs / gpu_scene.vs (std430, 96 bytes)
+struct GpuEntity {
+    glm::mat4 model;
+    glm::vec4 colorFlash; // rgb tint, a = hit flash
+    uint32_t info[4];     // [0] = model id
+};
+
+// GPU-driven scene path (needs GL 4.3): every registered model lives in one
+// shared vertex / index buffer, entities are uploaded as-is to a storage
+// buffer, and a compute pass frustum-culls them, picks the level of detail and
+// fills the instance counts of one glDrawElementsIndirect command per mesh.
+// The draw is then a handful of glMultiDrawElementsIndirect calls (one per run
+// of meshes sharing a texture), however many entities there are; the CPU only
+// writes one GpuEntity per entity.
+//
+// Visible instances reach the vertex shader through a per-instance vertex
+// attribute: command c's instances are visible[c * capacity ...], which the
+// command's baseInstance selects, so no gl_BaseInstance / GL 4.6 is needed.
+class GpuDrivenScene
+{
+public:
+    GpuDrivenScene() : mVAO(0), mVBO(0), mEBO(0), mEntityBuffer(0), mCommandBuffer(0), mVisibleBuffer(0),
+        mModelBuffer(0), mCullProgram(0), mEntityCountLocation(-1), mFrustumLocation(-1), mEyeLocation(-1),
+        mCapacity(0), mBuilt(false) {}
+
+    // GL 4.3 context with compute + multi-draw-indirect entry points, and
+    // SSBOs in the vertex stage (4.3 allows a limit of 0; gpu_scene.vs reads
+    // the entity buffer)
+    static bool Supported()
+    {
+        GLint major = 0, minor = 0;
+        glGetIntegerv(GL_MAJOR_VERSION, &major);
+        glGetIntegerv(GL_MINOR_VERSION, &minor);
+        if (major < 4 || (major == 4 && minor < 3)) return false;
+        GLint vertexBlocks = 0;
+        glGetIntegerv(GL_MAX_VERTEX_SHADER_STORAGE_BLOCKS, &vertexBlocks);
+        if (vertexBlocks < 1) return false;
+        return loadEntryPoints();
+    }
+
+    // Register a model before Build(); returns the id to Add() entities with.
+    // Entities of a model fall through to 'coarser' (another model id) while
+    // they cover fewer than minPixels on screen, which is how LODs chain up.
+    int AddModel(std::vector<Mesh>& meshes, const BoundingSphere& bounds, bool tintOnly,
+                 float minPixels = 0.0f, int coarser = -1)
+    {
+        ModelSource m = { &meshes, bounds, tintOnly, minPixels, coarser };
+        mSources.push_back(m);
+        return (int)mSources.size() - 1;
+    }
+
+    // pack the registered meshes and compile the cull / draw programs; the
+    // draw program is built twice from the fragment shader: with litDefines and
+    // with TINT_ONLY for the tint-only models
+    bool Build(const char* cullPath, const char* vertexPath, const char* fragmentPath,
+               const std::vector<std::string>& litDefines = {})
+    {
+        std::vector<Vertex> vertices;
+        std::vector<unsigned int> indices;
+        std::vector<ModelInfo> models;
+        for (const ModelSource& source : mSources) {
+            ModelInfo info;
+            info.bounds = glm::vec4(source.bounds.center, source.bounds.radius);
+            info.firstCommand = (uint32_t)mCommands.size();
+            info.commandCount = (uint32_t)source.meshes->size();
+            info.next = source.coarser;
+            info.minPixels = source.minPixels;
+            models.push_back(info);
+
+            for (const Mesh& mesh : *source.meshes) {
+                DrawCommand c;
+                c.count = (uint32_t)mesh.indices.size();
+                c.instanceCount = 0;
+                c.firstIndex = (uint32_t)indices.size();
+                c.baseVertex = (int32_t)vertices.size();
+                c.baseInstance = 0; // set by grow()
+                mCommands.push_back(c);
+
+                unsigned int texture = 0;
+                for (const Texture& t : mesh.textures)
+                    if (t.type == "texture_diffuse") { texture = t.id; break; }
+                if (mBatches.empty() || mBatches.back().texture != texture || mBatches.back().tintOnly != source.tintOnly)
+                    mBatches.push_back(Batch{ texture, source.tintOnly, (int)mCommands.size() - 1, 0 });
+                mBatches.back().commandCount++;
+
+                vertices.insert(vertices.end(), mesh.vertices.begin(), mesh.vertices.end());
+                indices.insert(indices.end(), mesh.indices.begin(), mesh.indices.end());
+            }
+        }
+
+        mCullProgram = compileCompute(cullPath);
+        if (!mCullProgram) return false;
+        mEntityCountLocation = glGetUniformLocation(mCullProgram, "entityCount");
+        mFrustumLocation = glGetUniformLocation(mCullProgram, "frustumPlanes");
+        mEyeLocation = glGetUniformLocation(mCullProgram, "eye");
+        mDrawShader.reset(new CachedShader(vertexPath, fragmentPath, nullptr, litDefines));
+        mTintShader.reset(new CachedShader(vertexPath, fragmentPath, nullptr, { "TINT_ONLY" }));
+        if (!linked(*mDrawShader) || !linked(*mTintShader)) {
+            glDeleteProgram(mCullProgram);
+            glDeleteProgram(mDrawShader->ID);
+            glDeleteProgram(mTintShader->ID);
+            mCullProgram = 0;
+            return false;
+        }
+
+        glGenVertexArrays(1, &mVAO);
+        glGenBuffers(1, &mVBO);
+        glGenBuffers(1, &mEBO);
+        glGenBuffers(1, &mEntityBuffer);
+        glGenBuffers(1, &mCommandBuffer);
+        glGenBuffers(1, &mVisibleBuffer);
+        glGenBuffers(1, &mModelBuffer);
+
+        glBindVertexArray(mVAO);
+        glBindBuffer(GL_ARRAY_BUFFER, mVBO);
+        glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(Vertex), vertices.data(), GL_STATIC_DRAW);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mEBO);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), indices.data(), GL_STATIC_DRAW);
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, Position));
+        glEnableVertexAttribArray(1);
+        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, Normal));
+        glEnableVertexAttribArray(2);
+        glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, TexCoords));
+
+        glBindBuffer(GL_ARRAY_BUFFER, mVisibleBuffer);
+        glEnableVertexAttribArray(kEntityAttrib);
+        glVertexAttribIPointer(kEntityAttrib, 1, GL_UNSIGNED_INT, sizeof(uint32_t), (void*)0);
+        glVertexAttribDivisor(kEntityAttrib, 1);
+        glBindVertexArray(0);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, mModelBuffer);
+        glBufferData(GL_SHADER_STORAGE_BUFFER, models.size() * sizeof(ModelInfo), models.data(), GL_STATIC_DRAW);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+        grow(256);
+        mBuilt = true;
+        return true;
+    }
+
+    // the draw programs, for the caller to hook up the PerFrame block
+    CachedShader& DrawShader(bool tintOnly) { return tintOnly ? *mTintShader : *mDrawShader; }
+
+    void Clear()
+    {
+        mEntities.clear();
+    }
+
+    void Add(int model, const glm::mat4& transform, const glm::vec3& color, float flash)
+    {
+        GpuEntity e;
+        e.model = transform;
+        e.colorFlash = glm::vec4(color, flash);
+        e.info[0] = (uint32_t)model;
+        e.info[1] = e.info[2] = e.info[3] = 0;
+        mEntities.push_back(e);
+    }
+
+    size_t Count() const { return mEntities.size(); }
+    size_t DrawCalls() const { return mBatches.size(); }
+
+    // cull on the GPU, then draw everything that survived; fovY in radians
+    void Draw(const glm::mat4& viewProjection, const glm::vec3& eye, float fovY, float viewportHeight)
+    {
+        if (!mBuilt || mEntities.empty()) return;
+        if (mEntities.size() > mCapacity)
+            grow(std::max(mEntities.size(), mCapacity * 2));
+
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, mEntityBuffer);
+        glBufferData(GL_SHADER_STORAGE_BUFFER, mCapacity * sizeof(GpuEntity), NULL, GL_STREAM_DRAW);
+        glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, mEntities.size() * sizeof(GpuEntity), mEntities.data());
+        // instance counts back to zero; the compute pass counts them up again
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, mCommandBuffer);
+        glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, mCommands.size() * sizeof(DrawCommand), mCommands.data());
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, mEntityBuffer);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, mCommandBuffer);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, mVisibleBuffer);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, mModelBuffer);
+
+        const Frustum frustum(viewProjection);
+        glUseProgram(mCullProgram);
+        glUniform1ui(mEntityCountLocation, (GLuint)mEntities.size());
+        glUniform4fv(mFrustumLocation, 6, &frustum.Planes()[0][0]);
+        glUniform4f(mEyeLocation, eye.x, eye.y, eye.z, viewportHeight / std::tan(fovY * 0.5f));
+        sDispatchCompute((GLuint)((mEntities.size() + 63) / 64), 1, 1);
+        sMemoryBarrier(GL_COMMAND_BARRIER_BIT | GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT | GL_SHADER_STORAGE_BARRIER_BIT);
+
+        glBindVertexArray(mVAO);
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, mCommandBuffer);
+        glActiveTexture(GL_TEXTURE0);
+        const CachedShader* program = nullptr;
+        for (const Batch& b : mBatches) {
+            const CachedShader* batchProgram = b.tintOnly ? mTintShader.get() : mDrawShader.get();
+            if (batchProgram != program) {
+                program = batchProgram;
+                program->use();
+            }
+            if (b.texture && !b.tintOnly) glBindTexture(GL_TEXTURE_2D, b.texture);
+            sMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT,
+                (void*)(b.firstCommand * sizeof(DrawCommand)), b.commandCount, 0);
+        }
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+        glBindVertexArray(0);
+    }
+
+    void Destroy()
+    {
+        if (!mBuilt) return;
+        glDeleteVertexArrays(1, &mVAO);
+        unsigned int buffers[] = { mVBO, mEBO, mEntityBuffer, mCommandBuffer, mVisibleBuffer, mModelBuffer };
+        glDeleteBuffers(6, buffers);
+        glDeleteProgram(mCullProgram);
+        glDeleteProgram(mDrawShader->ID);
+        glDeleteProgram(mTintShader->ID);
+        mBuilt = false;
+    }
+
+private:
+    static const unsigned int kEntityAttrib = 7;
+
+    struct ModelSource {
+        std::vector<Mesh>* meshes;
+        BoundingSphere bounds;
+        bool tintOnly;
+        float minPixels;
+        int coarser;
+    };
+
+    // std430 layouts, see gpu_cull.cs
+    struct ModelInfo {
+        glm::vec4 bounds;
+        uint32_t firstCommand;
+        uint32_t commandCount;
+        int32_t next;
+        float minPixels;
+    };
+
+    struct DrawCommand {
+        uint32_t count;
+        uint32_t instanceCount;
+        uint32_t firstIndex;
+        int32_t baseVertex;
+        uint32_t baseInstance;
+    };
+
+    // consecutive commands drawn with one glMultiDrawElementsIndirect
+    struct Batch {
+        unsigned int texture; // first diffuse texture, 0 = leave unit 0 alone
+        bool tintOnly;
+        int firstCommand;
+        int commandCount;
+    };
+
+    typedef void (APIENTRY* DispatchComputeProc)(GLuint, GLuint, GLuint);
+    typedef void (APIENTRY* MemoryBarrierProc)(GLbitfield);
+    typedef void (APIENTRY* MultiDrawElementsIndirectProc)(GLenum, GLenum, const void*, GLsizei, GLsizei);
+    // loaded here rather than through glad, whose generated loader may stop at 3.3
+    static inline DispatchComputeProc sDispatchCompute = nullptr;
+    static inline MemoryBarrierProc sMemoryBarrier = nullptr;
+    static inline MultiDrawElementsIndirectProc sMultiDrawElementsIndirect = nullptr;
+
+    std::vector<ModelSource> mSources;
+    std::vector<DrawCommand> mCommands; // reset template: instanceCount = 0
+    std::vector<Batch> mBatches;
+    std::vector<GpuEntity> mEntities;
+    std::unique_ptr<CachedShader> mDrawShader;
+    std::unique_ptr<CachedShader> mTintShader;
+    unsigned int mVAO, mVBO, mEBO;
+    unsigned int mEntityBuffer, mCommandBuffer, mVisibleBuffer, mModelBuffer;
+    unsigned int mCullProgram;
+    GLint mEntityCountLocation, mFrustumLocation, mEyeLocation;
+    size_t mCapacity; // entities; each command has this many visible slots
+    bool mBuilt;
+
+    static bool loadEntryPoints()
+    {
+        sDispatchCompute = (DispatchComputeProc)glfwGetProcAddress("glDispatchCompute");
+        sMemoryBarrier = (MemoryBarrierProc)glfwGetProcAddress("glMemoryBarrier");
+        sMultiDrawElementsIndirect = (MultiDrawElementsIndirectProc)glfwGetProcAddress("glMultiDrawElementsIndirect");
+        return sDispatchCompute && sMemoryBarrier && sMultiDrawElementsIndirect;
+    }
+
+    void grow(size_t capacity)
+    {
+        mCapacity = capacity;
+        for (size_t c = 0; c < mCommands.size(); c++)
+            mCommands[c].baseInstance = (uint32_t)(c * mCapacity);
+
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, mCommandBuffer);
+        glBufferData(GL_SHADER_STORAGE_BUFFER, mCommands.size() * sizeof(DrawCommand), mCommands.data(), GL_DYNAMIC_DRAW);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, mVisibleBuffer);
+        glBufferData(GL_SHADER_STORAGE_BUFFER, mCommands.size() * mCapacity * sizeof(uint32_t), NULL, GL_DYNAMIC_DRAW);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+    }
+
+    static bool linked(const CachedShader& shader)
+    {
+        GLint ok = 0;
+        if (shader.ID)
+            glGetProgramiv(shader.ID, GL_LINK_STATUS, &ok);
+        return ok != 0;
+    }
+
+    static unsigned int compileCompute(const char* path)
+    {
+        std::ifstream file(path);
+        if (!file) {
+            std::cout << "ERROR::SHADER::FILE_NOT_SUCCESSFULLY_READ: " << path << std::endl;
+            return 0;
+        }
+        std::stringstream stream;
+        stream << file.rdbuf();
+        std::string code = stream.str();
+        const char* source = code.c_str();
+
+        GLint ok = 0;
+        char log[1024];
+        unsigned int shader = glCreateShader(GL_COMPUTE_SHADER);
+        glShaderSource(shader, 1, &source, NULL);
+        glCompileShader(shader);
+        glGetShaderiv(shader, GL_COMPILE_STATUS, &ok);
+        if (!ok) {
+            glGetShaderInfoLog(shader, sizeof(log), NULL, log);
+            std::cout << "ERROR::SHADER_COMPILATION_ERROR of type: COMPUTE\n" << log << std::endl;
+            glDeleteShader(shader);
+            return 0;
+        }
+        unsigned int program = glCreateProgram();
+        glAttachShader(program, shader);
+        glLinkProgram(program);
+        glDeleteShader(shader);
+        glGetProgramiv(program, GL_LINK_STATUS, &ok);
+        if (!ok) {
+            glGetProgramInfoLog(program, sizeof(log), NULL, log);
+            std::cout << "ERROR::PROGRAM_LINKING_ERROR of type: COMPUTE\n" << log << std::endl;
+            glDeleteProgram(program);
+            return 0;
+        }
+        return program;
+    }
+};
+
+#endif
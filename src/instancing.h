@@ -0,0 +1,142 @@
+#ifndef INSTANCING_H
+#define INSTANCING_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <learnopengl/shader.h>
+#include <learnopengl/model.h>
+
+#include "cached_shader.h"
+#include "render_queue.h"
+
+#include <vector>
+#include <cstddef>
+#include <algorithm>
+
+// per-instance data, matches the instance attributes in 6.bloom.vs
+struct InstanceData {
+    glm::mat4 model;
+    glm::vec3 color;
+    float hitFlash;
+};
+
+// Vertex attribute slots 0-6 are taken by the learnopengl Mesh layout
+// (position, normal, texcoords, tangent, bitangent, bone ids, weights).
+const unsigned int kInstanceAttribModel = 7; // mat4 -> 7, 8, 9, 10
+const unsigned int kInstanceAttribColor = 11;
+const unsigned int kInstanceAttribFlash = 12;
+
+// Draws every instance of a model (its mesh list, from Model or CookedModel)
+// with one glDrawElementsInstanced per mesh, submitted to a RenderQueue. The
+// instance buffer is hooked into the meshes' own VAOs, so only one
+// InstancedModel may wrap a given model at a time.
+class InstancedModel
+{
+public:
+    InstancedModel(std::vector<Mesh>& meshes) : mMeshes(meshes), mVBO(0), mCapacity(0)
+    {
+        glGenBuffers(1, &mVBO);
+        glBindBuffer(GL_ARRAY_BUFFER, mVBO);
+
+        const GLsizei stride = sizeof(InstanceData);
+        for (Mesh& mesh : mMeshes)
+        {
+            glBindVertexArray(mesh.VAO);
+            for (unsigned int i = 0; i < 4; i++)
+            {
+                glEnableVertexAttribArray(kInstanceAttribModel + i);
+                glVertexAttribPointer(kInstanceAttribModel + i, 4, GL_FLOAT, GL_FALSE, stride,
+                    (void*)(offsetof(InstanceData, model) + sizeof(glm::vec4) * i));
+                glVertexAttribDivisor(kInstanceAttribModel + i, 1);
+            }
+            glEnableVertexAttribArray(kInstanceAttribColor);
+            glVertexAttribPointer(kInstanceAttribColor, 3, GL_FLOAT, GL_FALSE, stride, (void*)offsetof(InstanceData, color));
+            glVertexAttribDivisor(kInstanceAttribColor, 1);
+
+            glEnableVertexAttribArray(kInstanceAttribFlash);
+            glVertexAttribPointer(kInstanceAttribFlash, 1, GL_FLOAT, GL_FALSE, stride, (void*)offsetof(InstanceData, hitFlash));
+            glVertexAttribDivisor(kInstanceAttribFlash, 1);
+        }
+        glBindVertexArray(0);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+
+    // frees the instance buffer; call while the context is still current
+    void Destroy()
+    {
+        glDeleteBuffers(1, &mVBO);
+        mVBO = 0;
+    }
+
+    void Clear()
+    {
+        mInstances.clear();
+    }
+
+    void Add(const glm::mat4& model, const glm::vec3& color, float hitFlash)
+    {
+        InstanceData d;
+        d.model = model;
+        d.color = color;
+        d.hitFlash = hitFlash;
+        mInstances.push_back(d);
+    }
+
+    size_t Count() const
+    {
+        return mInstances.size();
+    }
+
+    // upload this frame's instances; call before the queue is flushed
+    void Upload()
+    {
+        if (mInstances.empty()) return;
+
+        glBindBuffer(GL_ARRAY_BUFFER, mVBO);
+        if (mInstances.size() > mCapacity)
+        {
+            // grow geometrically so a rising entity count doesn't realloc every frame
+            mCapacity = std::max(mInstances.size(), mCapacity * 2);
+        }
+        // orphan last frame's storage so the driver doesn't have to sync with in-flight draws
+        glBufferData(GL_ARRAY_BUFFER, mCapacity * sizeof(InstanceData), NULL, GL_STREAM_DRAW);
+        glBufferSubData(GL_ARRAY_BUFFER, 0, mInstances.size() * sizeof(InstanceData), mInstances.data());
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+
+    // one queue item per mesh. 6.bloom.fs samples only unit 0, so each textured
+    // mesh gets its first diffuse map, or fallbackTexture without one; untextured
+    // draws (the tint-only program) leave unit 0 as it is
+    void Submit(RenderQueue& queue, const CachedShader& shader, bool textured, unsigned int fallbackTexture, float depth = 0.0f) const
+    {
+        if (mInstances.empty()) return;
+
+        for (const Mesh& mesh : mMeshes)
+        {
+            RenderItem item;
+            item.shader = &shader;
+            item.texture = textured ? diffuseTexture(mesh, fallbackTexture) : 0;
+            item.vao = mesh.VAO;
+            item.count = static_cast<GLsizei>(mesh.indices.size());
+            item.instances = static_cast<GLsizei>(mInstances.size());
+            queue.Submit(PASS_OPAQUE, item, depth);
+        }
+    }
+
+private:
+    std::vector<Mesh>& mMeshes;
+    unsigned int mVBO;
+    size_t mCapacity;
+    std::vector<InstanceData> mInstances;
+
+    static unsigned int diffuseTexture(const Mesh& mesh, unsigned int fallback)
+    {
+        for (const Texture& texture : mesh.textures)
+            if (texture.type == "texture_diffuse")
+                return texture.id;
+        return fallback;
+    }
+};
+
+#endif
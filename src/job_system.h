@@ -0,0 +1,171 @@
+#ifndef JOB_SYSTEM_H
+#define JOB_SYSTEM_H
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+// Small work-stealing job system for data-parallel loops.
+//
+// Every thread (the caller counts as thread 0) has its own job deque. A thread
+// takes work from the back of its own deque and, when that is empty, steals
+// from the front of the others, so chunks spread over the cores without one
+// shared queue everybody contends on. The caller of ParallelFor works on its
+// own jobs too and returns once all of them have finished.
+//
+// Jobs are plain function pointer + context records, so a ParallelFor does not
+// allocate once the deques have grown to size.
+class JobSystem
+{
+public:
+    // threads includes the calling thread; 0 = one per hardware thread
+    JobSystem(unsigned int threads = 0) : mQueued(0), mQuit(false)
+    {
+        if (threads == 0)
+            threads = std::max(1u, std::thread::hardware_concurrency());
+        for (unsigned int i = 0; i < threads; i++)
+            mQueues.emplace_back(new Queue());
+        for (unsigned int i = 1; i < threads; i++)
+            mWorkers.emplace_back(&JobSystem::workerLoop, this, i);
+    }
+
+    ~JobSystem()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mWakeMutex);
+            mQuit = true;
+        }
+        mWake.notify_all();
+        for (std::thread& t : mWorkers)
+            t.join();
+    }
+
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+
+    unsigned int Threads() const { return (unsigned int)mQueues.size(); }
+
+    // call f(begin, end) on sub-ranges of [0, count), at least grain items
+    // each, and wait for all of them. f may run on any thread and must only
+    // write data owned by its own range.
+    template <typename F>
+    void ParallelFor(int count, int grain, F&& f)
+    {
+        grain = std::max(grain, 1);
+        int threads = (int)mQueues.size();
+        int chunks = std::min((count + grain - 1) / grain, threads * 4);
+        if (chunks <= 1 || threads == 1) {
+            if (count > 0) f(0, count);
+            return;
+        }
+
+        typedef typename std::remove_reference<F>::type Fn;
+        int per = (count + chunks - 1) / chunks;
+        chunks = (count + per - 1) / per; // no empty tail chunks
+        std::atomic<int> remaining(chunks); // after the recount, or the wait below never ends
+        mQueued.fetch_add(chunks);
+        for (int c = 0; c < chunks; c++) {
+            Job job;
+            job.run = [](void* ctx, int begin, int end) { (*static_cast<Fn*>(ctx))(begin, end); };
+            job.ctx = const_cast<void*>(static_cast<const void*>(&f));
+            job.begin = c * per;
+            job.end = std::min(count, job.begin + per);
+            job.remaining = &remaining;
+
+            Queue& q = *mQueues[c % threads];
+            std::lock_guard<std::mutex> lock(q.mutex);
+            q.jobs.push_back(job);
+        }
+        {
+            // a worker between its empty check and wait() holds the mutex, so it can't miss this
+            std::lock_guard<std::mutex> lock(mWakeMutex);
+        }
+        mWake.notify_all();
+
+        while (remaining.load() > 0) {
+            if (!runOne(0))
+                std::this_thread::yield();
+        }
+    }
+
+private:
+    struct Job {
+        void (*run)(void* ctx, int begin, int end);
+        void* ctx;
+        int begin;
+        int end;
+        std::atomic<int>* remaining;
+    };
+
+    struct Queue {
+        std::mutex mutex;
+        std::deque<Job> jobs;
+    };
+
+    std::vector<std::unique_ptr<Queue>> mQueues; // [0] is the calling thread's
+    std::vector<std::thread> mWorkers;
+    std::atomic<int> mQueued;                    // jobs sitting in any deque
+    std::mutex mWakeMutex;
+    std::condition_variable mWake;
+    bool mQuit;
+
+    // own deque first (newest job, still warm in cache), then steal the oldest from the others
+    bool take(unsigned int self, Job& job)
+    {
+        unsigned int n = (unsigned int)mQueues.size();
+        for (unsigned int k = 0; k < n; k++) {
+            Queue& q = *mQueues[(self + k) % n];
+            std::lock_guard<std::mutex> lock(q.mutex);
+            if (q.jobs.empty()) continue;
+            if (k == 0) {
+                job = q.jobs.back();
+                q.jobs.pop_back();
+            }
+            else {
+                job = q.jobs.front();
+                q.jobs.pop_front();
+            }
+            mQueued.fetch_sub(1);
+            return true;
+        }
+        return false;
+    }
+
+    bool runOne(unsigned int self)
+    {
+        Job job;
+        if (!take(self, job)) return false;
+        job.run(job.ctx, job.begin, job.end);
+        job.remaining->fetch_sub(1);
+        return true;
+    }
+
+    void workerLoop(unsigned int self)
+    {
+        for (;;) {
+            if (runOne(self)) continue;
+
+            std::unique_lock<std::mutex> lock(mWakeMutex);
+            mWake.wait(lock, [this] { return mQuit || mQueued.load() > 0; });
+            if (mQuit) return;
+        }
+    }
+};
+
+// ParallelFor through jobs, or a plain call on this thread when jobs is null
+template <typename F>
+inline void parallelFor(JobSystem* jobs, int count, int grain, F&& f)
+{
+    if (jobs)
+        jobs->ParallelFor(count, grain, f);
+    else if (count > 0)
+        f(0, count);
+}
+
+#endif
@@ -0,0 +1,242 @@
+#ifndef MESH_CACHE_H
+#define MESH_CACHE_H
+
+#include <glad/glad.h>
+
+#include <learnopengl/shader.h>
+#include <learnopengl/model.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "mapped_file.h"
+#include "texture_loader.h"
+
+// Drop-in for learnopengl's Model (same public members and Draw) that skips
+// Assimp after the first launch.
+//
+// The first load imports the source through Model as before and writes
+// "<source>.cooked" next to it: every mesh's interleaved Vertex array, its
+// indices and its texture references. Later launches mmap the cooked file and
+// build the meshes straight from it. The cooked file records a hash of the
+// source file and sizeof(Vertex), and is re-cooked when either changes.
+//
+// Given a TextureLoader, the model's textures are queued on it like every
+// other texture (decoded on its workers, BCn-compressed and cached in .ctex);
+// they become resident with the loader's Finish(). Without one they load
+// synchronously through TextureFromFile as in Model.
+class CookedModel
+{
+public:
+    vector<Texture> textures_loaded;
+    vector<Mesh>    meshes;
+    string directory;
+    bool gammaCorrection;
+
+    CookedModel(const string& path, bool gamma = false, TextureLoader* textureLoader = nullptr)
+        : gammaCorrection(gamma), mTextureLoader(textureLoader)
+    {
+        directory = path.substr(0, path.find_last_of('/'));
+
+        MappedFile source;
+        if (!source.Open(path)) {
+            std::cout << "ERROR::MESH_CACHE: can't read " << path << std::endl;
+            return;
+        }
+        uint64_t sourceHash = hashBytes(source.Data(), source.Size());
+        source.Close();
+
+        const string cookedPath = path + ".cooked";
+        if (loadCooked(cookedPath, sourceHash))
+            return;
+
+        // cache miss or stale: import with Assimp once and cook the result
+        Model model(path, gamma);
+        meshes = model.meshes;
+        if (mTextureLoader) {
+            // Model has already uploaded them uncompressed; swap in the loader's versions
+            for (const Texture& t : model.textures_loaded)
+                glDeleteTextures(1, &t.id);
+            for (Mesh& mesh : meshes)
+                for (Texture& t : mesh.textures)
+                    t.id = loadTexture(t.path);
+        }
+        else {
+            textures_loaded = model.textures_loaded;
+        }
+        if (!writeCooked(cookedPath, sourceHash))
+            std::cout << "ERROR::MESH_CACHE: failed to write " << cookedPath << std::endl;
+    }
+
+    void Draw(Shader& shader)
+    {
+        for (unsigned int i = 0; i < meshes.size(); i++)
+            meshes[i].Draw(shader);
+    }
+
+private:
+    TextureLoader* mTextureLoader;
+
+    static_assert(std::is_trivially_copyable<Vertex>::value, "Vertex is written to the cache as raw bytes");
+
+    static const uint32_t kMagic = 0x4B4F4F43; // "COOK"
+    static const uint32_t kVersion = 1;
+
+    struct FileHeader {
+        uint32_t magic;
+        uint32_t version;
+        uint64_t sourceHash;
+        uint32_t vertexSize;
+        uint32_t meshCount;
+    };
+
+    struct MeshHeader {
+        uint32_t vertexCount;
+        uint32_t indexCount;
+        uint32_t textureCount;
+        uint32_t reserved;
+    };
+
+    // bounds-checked cursor over the mapped file
+    struct Reader {
+        const unsigned char* p;
+        const unsigned char* end;
+
+        // count elements of elementSize bytes left in the file? (check before allocating for them)
+        bool Fits(uint32_t count, size_t elementSize) const
+        {
+            return (uint64_t)count * elementSize <= (uint64_t)(end - p);
+        }
+
+        bool Read(void* dst, size_t n)
+        {
+            if ((size_t)(end - p) < n) return false;
+            std::memcpy(dst, p, n);
+            p += n;
+            return true;
+        }
+
+        bool ReadString(string& s)
+        {
+            uint32_t len;
+            if (!Read(&len, sizeof(len)) || (size_t)(end - p) < len) return false;
+            s.assign((const char*)p, len);
+            p += len;
+            return true;
+        }
+    };
+
+    bool loadCooked(const string& cookedPath, uint64_t sourceHash)
+    {
+        MappedFile file;
+        if (!file.Open(cookedPath))
+            return false;
+
+        Reader in = { file.Data(), file.Data() + file.Size() };
+        FileHeader header;
+        if (!in.Read(&header, sizeof(header)) || header.magic != kMagic || header.version != kVersion
+            || header.sourceHash != sourceHash || header.vertexSize != sizeof(Vertex))
+            return false;
+
+        // Parse and validate the whole file before creating any GL object, so a
+        // truncated or corrupt cache just falls back to the import. Counts come
+        // from the file and are checked against the bytes left before allocating.
+        if (!in.Fits(header.meshCount, sizeof(MeshHeader)))
+            return false;
+        struct CookedMesh {
+            vector<Vertex> vertices;
+            vector<unsigned int> indices;
+            vector<Texture> textures;
+        };
+        vector<CookedMesh> parsed(header.meshCount);
+        for (CookedMesh& cm : parsed) {
+            MeshHeader mh;
+            if (!in.Read(&mh, sizeof(mh)) || !in.Fits(mh.vertexCount, sizeof(Vertex)))
+                return false;
+            cm.vertices.resize(mh.vertexCount);
+            if (!in.Read(cm.vertices.data(), cm.vertices.size() * sizeof(Vertex))
+                || !in.Fits(mh.indexCount, sizeof(unsigned int)))
+                return false;
+            cm.indices.resize(mh.indexCount);
+            if (!in.Read(cm.indices.data(), cm.indices.size() * sizeof(unsigned int)))
+                return false;
+
+            // each texture reference is at least two length prefixes
+            if (!in.Fits(mh.textureCount, 2 * sizeof(uint32_t)))
+                return false;
+            cm.textures.resize(mh.textureCount);
+            for (Texture& texture : cm.textures)
+                if (!in.ReadString(texture.type) || !in.ReadString(texture.path))
+                    return false;
+        }
+
+        // everything read: now the textures and VAOs
+        vector<Mesh> loaded;
+        loaded.reserve(parsed.size());
+        for (CookedMesh& cm : parsed) {
+            for (Texture& texture : cm.textures)
+                texture.id = loadTexture(texture.path);
+            loaded.push_back(Mesh(cm.vertices, cm.indices, cm.textures));
+        }
+        meshes = loaded;
+        return true;
+    }
+
+    // same de-duplication as Model::loadMaterialTextures
+    unsigned int loadTexture(const string& path)
+    {
+        for (const Texture& t : textures_loaded)
+            if (t.path == path)
+                return t.id;
+
+        Texture texture;
+        if (mTextureLoader)
+            texture.id = mTextureLoader->Texture2D(directory + '/' + path, gammaCorrection);
+        else
+            texture.id = TextureFromFile(path.c_str(), directory, gammaCorrection);
+        texture.path = path;
+        textures_loaded.push_back(texture);
+        return texture.id;
+    }
+
+    bool writeCooked(const string& cookedPath, uint64_t sourceHash) const
+    {
+        // write to a temp file and rename, so a crash mid-write never leaves a truncated cache
+        const string tmpPath = cookedPath + ".tmp";
+        {
+            std::ofstream out(tmpPath, std::ios::binary | std::ios::trunc);
+            if (!out) return false;
+
+            FileHeader header = { kMagic, kVersion, sourceHash, (uint32_t)sizeof(Vertex), (uint32_t)meshes.size() };
+            out.write((const char*)&header, sizeof(header));
+            for (const Mesh& mesh : meshes) {
+                MeshHeader mh = { (uint32_t)mesh.vertices.size(), (uint32_t)mesh.indices.size(), (uint32_t)mesh.textures.size(), 0 };
+                out.write((const char*)&mh, sizeof(mh));
+                out.write((const char*)mesh.vertices.data(), mesh.vertices.size() * sizeof(Vertex));
+                out.write((const char*)mesh.indices.data(), mesh.indices.size() * sizeof(unsigned int));
+                for (const Texture& texture : mesh.textures) {
+                    writeString(out, texture.type);
+                    writeString(out, texture.path);
+                }
+            }
+            if (!out) return false;
+        }
+        std::remove(cookedPath.c_str());
+        return std::rename(tmpPath.c_str(), cookedPath.c_str()) == 0;
+    }
+
+    static void writeString(std::ofstream& out, const string& s)
+    {
+        uint32_t len = (uint32_t)s.size();
+        out.write((const char*)&len, sizeof(len));
+        out.write(s.data(), len);
+    }
+};
+
+#endif
@@ -0,0 +1,153 @@
+#ifndef MESH_LOD_H
+#define MESH_LOD_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <learnopengl/model.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "frustum.h"
+
+// model-space sphere around every vertex of every mesh (centered on their box)
+inline BoundingSphere meshBounds(const std::vector<Mesh>& meshes)
+{
+    glm::vec3 lo(1e30f), hi(-1e30f);
+    for (const Mesh& mesh : meshes)
+        for (const Vertex& v : mesh.vertices) {
+            lo = glm::min(lo, v.Position);
+            hi = glm::max(hi, v.Position);
+        }
+    BoundingSphere s;
+    if (lo.x > hi.x) return s; // no vertices
+    s.center = (lo + hi) * 0.5f;
+    for (const Mesh& mesh : meshes)
+        for (const Vertex& v : mesh.vertices)
+            s.radius = std::max(s.radius, glm::length(v.Position - s.center));
+    return s;
+}
+
+// 21 bits of a grid coordinate, for packing three into a 64-bit cell key
+inline uint64_t cellIndex(float g)
+{
+    return (uint64_t)((int64_t)std::floor(g) & 0x1FFFFF);
+}
+
+// Vertex clustering: snap every vertex to a grid of cellSize cubes, merge each
+// cell into one averaged vertex and drop the triangles that collapse. Needs a
+// GL context (the result is a ready-to-draw Mesh).
+inline Mesh simplifyMesh(const Mesh& mesh, const glm::vec3& origin, float cellSize)
+{
+    std::unordered_map<uint64_t, unsigned int> cells;
+    std::vector<Vertex> vertices;
+    std::vector<float> weights;
+    std::vector<unsigned int> remap(mesh.vertices.size());
+
+    for (size_t i = 0; i < mesh.vertices.size(); i++) {
+        const Vertex& v = mesh.vertices[i];
+        glm::vec3 g = (v.Position - origin) / cellSize;
+        uint64_t key = (cellIndex(g.x) << 42) | (cellIndex(g.y) << 21) | cellIndex(g.z);
+
+        auto it = cells.find(key);
+        if (it == cells.end()) {
+            it = cells.emplace(key, (unsigned int)vertices.size()).first;
+            vertices.push_back(v); // bone ids / weights from the first vertex in the cell
+            weights.push_back(1.0f);
+        }
+        else {
+            Vertex& sum = vertices[it->second];
+            sum.Position += v.Position;
+            sum.Normal += v.Normal;
+            sum.TexCoords += v.TexCoords;
+            sum.Tangent += v.Tangent;
+            sum.Bitangent += v.Bitangent;
+            weights[it->second] += 1.0f;
+        }
+        remap[i] = it->second;
+    }
+
+    for (size_t i = 0; i < vertices.size(); i++) {
+        Vertex& v = vertices[i];
+        v.Position /= weights[i];
+        v.TexCoords /= weights[i];
+        if (glm::dot(v.Normal, v.Normal) > 0.0f) v.Normal = glm::normalize(v.Normal);
+        if (glm::dot(v.Tangent, v.Tangent) > 0.0f) v.Tangent = glm::normalize(v.Tangent);
+        if (glm::dot(v.Bitangent, v.Bitangent) > 0.0f) v.Bitangent = glm::normalize(v.Bitangent);
+    }
+
+    // keep triangles whose corners landed in three different cells, once each
+    std::vector<unsigned int> indices;
+    std::unordered_set<uint64_t> seen;
+    for (size_t i = 0; i + 2 < mesh.indices.size(); i += 3) {
+        unsigned int a = remap[mesh.indices[i]], b = remap[mesh.indices[i + 1]], c = remap[mesh.indices[i + 2]];
+        if (a == b || b == c || a == c) continue;
+        unsigned int lo = std::min(a, std::min(b, c)), hi = std::max(a, std::max(b, c));
+        uint64_t key = ((uint64_t)lo << 42) | ((uint64_t)(a + b + c - lo - hi) << 21) | hi;
+        if (!seen.insert(key).second) continue;
+        indices.push_back(a);
+        indices.push_back(b);
+        indices.push_back(c);
+    }
+    return Mesh(vertices, indices, mesh.textures);
+}
+
+// A model's meshes plus coarser copies generated at load time, and the
+// bounding sphere used to cull and pick between them. Level 0 is the model's
+// own mesh list; the others are built by simplifyMesh() with a grid of
+// kLodCells[level] cells across the bounding sphere's diameter. Meshes that
+// collapse to nothing at a level are left out of it.
+class LodModel
+{
+public:
+    static const int kLevels = 3;
+    // full detail at kLod1Pixels on screen and up, LOD 1 down to kLod2Pixels, then LOD 2
+    static constexpr float kLod1Pixels = 96.0f;
+    static constexpr float kLod2Pixels = 32.0f;
+
+    BoundingSphere Bounds; // model space
+
+    LodModel(std::vector<Mesh>& meshes) : Bounds(meshBounds(meshes)), mFull(meshes)
+    {
+        const int kLodCells[kLevels] = { 0, 24, 8 };
+        glm::vec3 origin = Bounds.center - glm::vec3(Bounds.radius);
+        for (int level = 1; level < kLevels; level++) {
+            float cellSize = std::max(2.0f * Bounds.radius / kLodCells[level], 1e-6f);
+            for (const Mesh& mesh : meshes) {
+                Mesh simplified = simplifyMesh(mesh, origin, cellSize);
+                if (!simplified.indices.empty())
+                    mCoarse[level - 1].push_back(simplified);
+            }
+        }
+    }
+
+    // the list handed to InstancedModel / Draw; stays at the same address
+    std::vector<Mesh>& Level(int level)
+    {
+        return level == 0 ? mFull : mCoarse[level - 1];
+    }
+
+    static int SelectLevel(float projectedPixels)
+    {
+        if (projectedPixels >= kLod1Pixels) return 0;
+        return projectedPixels >= kLod2Pixels ? 1 : 2;
+    }
+
+    size_t Triangles(int level)
+    {
+        size_t n = 0;
+        for (const Mesh& mesh : Level(level)) n += mesh.indices.size() / 3;
+        return n;
+    }
+
+private:
+    std::vector<Mesh>& mFull;
+    std::vector<Mesh> mCoarse[kLevels - 1];
+};
+
+#endif
@@ -11,82 +11,70 @@
 #include <learnopengl/camera.h>
 #include <learnopengl/model.h>
 
+#include "world.h"
+#include "cached_shader.h"
+#include "frame_uniforms.h"
+#include "gl_state.h"
+#include "render_queue.h"
+#include "instancing.h"
+#include "frustum.h"
+#include "mesh_lod.h"
+#include "gpu_driven.h"
+#include "text_renderer.h"
+#include "profiler.h"
+#include "mesh_cache.h"
+#include "texture_loader.h"
+#include "replay.h"
+#include "triple_buffer.h"
+#include "render_snapshot.h"
+#include "job_system.h"
+#include "sound_pool.h"
+#include "audio.h"
+#include "audio_irrklang.h"
+#include "wav_audio.h"
+
+#include <atomic>
+#include <chrono>
 #include <iostream>
+#include <thread>
 #include <vector>
 #include <cstdlib>
+#include <cstring>
 #include <ctime>
 #include <assimp/Importer.hpp>
 #include <assimp/scene.h>
 #include <assimp/postprocess.h>
-#include <irrKlang/irrKlang.h>
-using namespace irrklang;
+#include <memory>
 
-ISoundEngine* gSound = nullptr;
-#include <map>
-#include <ft2build.h>
-#include FT_FREETYPE_H
+// hit / damage effects: decoded once at startup, played through a capped voice pool
+SoundPool gSfx;
 
 void framebuffer_size_callback(GLFWwindow* window, int width, int height);
 void mouse_callback(GLFWwindow* window, double xpos, double ypos);
 void scroll_callback(GLFWwindow* window, double xoffset, double yoffset);
 void processInput(GLFWwindow* window);
-unsigned int loadTexture(const char* path, bool gammaCorrection);
 void renderQuad();
 void renderQuad_cross();
 void renderHealthBar(float healthPercent, bool inner);
-void RenderText(Shader& s, const std::string& text,
-    float x, float y, float scale, glm::vec3 color);
-
-// Text rendering
-struct Character {
-    unsigned int TextureID;
-    glm::ivec2   Size;
-    glm::ivec2   Bearing;
-    unsigned int Advance;
-};
-
-std::map<char, Character> Characters;
-unsigned int textVAO = 0;
-unsigned int textVBO = 0;
-
-
-unsigned int loadCubemap(vector<std::string> faces)
-{
-    unsigned int textureID;
-    glGenTextures(1, &textureID);
-    glBindTexture(GL_TEXTURE_CUBE_MAP, textureID);
-
-    int width, height, nrComponents;
-    for (unsigned int i = 0; i < faces.size(); i++)
-    {
-        unsigned char* data = stbi_load(faces[i].c_str(), &width, &height, &nrComponents, 0);
-        if (data)
-        {
-            glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, data);
-            stbi_image_free(data);
-        }
-        else
-        {
-            std::cout << "Cubemap texture failed to load at path: " << faces[i] << std::endl;
-            stbi_image_free(data);
-        }
-    }
-    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
 
-    return textureID;
-}
 // settings
 const unsigned int SCR_WIDTH = 800;
 const unsigned int SCR_HEIGHT = 600;
 bool bloom = true;
 float exposure = 1.0f;
-int programChoice = 1;
+const float kExposureSpeed = 0.06f; // per second held (0.001 a frame at 60 Hz)
+int programChoice = 3; // 1: no bloom, 2: additive bloom, 3: physically based (mix) bloom
+const int kBloomModes = 3;
 float bloomFilterRadius = 0.005f;
 
+// render targets are framebuffer size * renderScale, upscaled (or downsampled) in the final pass
+int framebufferWidth = SCR_WIDTH;
+int framebufferHeight = SCR_HEIGHT;
+float renderScale = 1.0f;
+const float kMinRenderScale = 0.5f;
+const float kMaxRenderScale = 2.0f;
+const float kRenderScaleStep = 0.25f;
+
 // camera
 Camera camera(glm::vec3(0.0f, 0.0f, 4.0f));
 float lastX = (float)SCR_WIDTH / 2.0;
@@ -95,62 +83,38 @@ bool firstMouse = true;
 float yawMin = -120.0f;
 float yawMax = 0.0f;
 
-// bullets
-struct Bullet {
-    glm::vec3 position;
-    glm::vec3 direction;
-    float speed;
-};
-std::vector<Bullet> bullets;
-std::vector<Bullet> enemyBullets;
-
-float shootCooldown = 0.25f;
-float timeSinceLastShot = 0.0f;
-
-float enemyShootCooldown = 1.5f;
-float timeSinceLastEnemyShot = 0.0f;
-
-
-// player
-glm::vec3 playerPosition = glm::vec3(0.0f, -0.8f, 3.0f);
-float playerSpeed = 3.0f;
-// health + score
-float playerHealth = 100.0f;
-const float playerMaxHealth = 100.0f;
-int   playerScore = 0;
+// game simulation (player, bullets, enemies) - see world.h
+World world;
+PlayerInput playerInput;
+// --record <file> logs every Step() input for bench/replay_sim
+InputRecorder inputRecorder;
 
-enum EnemyState { ENEMY_ALIVE, ENEMY_DYING, ENEMY_DEAD };
 enum GameState { GAME_START, GAME_PLAYING, GAME_PAUSED, GAME_OVER };
 GameState gameState = GAME_START;
 
-struct Enemy {
-    glm::vec3 position;
-    glm::vec3 color;
-    bool alive = true;
-    EnemyState state = ENEMY_ALIVE;
-    float deathT = 0.0f;
-    float flashT = 0.0f;
-};
-
-const float kFlashDur = 0.12f;
-const float kFlashBoost = 1.2f;
-// Player hit flash
-float playerFlashT = 0.0f;           
-const float kPlayerFlashDur = 1.0f;
-const float kPlayerFlashBoost = 2.0f;
-
-std::vector<Enemy> enemies;
-float enemySpeed = 1.0f;
-bool moveRight = true;
-float enemyStepDown = 0.05f;
-float randomFloat(float min, float max) {
-    return min + static_cast<float>(rand()) / (static_cast<float>(RAND_MAX / (max - min)));
-}
-
 // timing
 float deltaTime = 0.0f;
 float lastFrame = 0.0f;
 
+// the simulation runs at a fixed rate (--sim-hz, default 60) independent of the render rate;
+// frames render the world blended between its last two ticks by simAlpha
+float simHz = 60.0f;
+const int kMaxSimStepsPerFrame = 8; // after a long hitch drop the backlog instead of spiralling
+float simAccumulator = 0.0f;
+float simAlpha = 1.0f;
+
+// frame profiler: F1 toggles the overlay, F2 starts / stops a Chrome trace capture
+FrameProfiler profiler;
+bool showProfiler = false;
+const char* kTracePath = "profile_trace.json";
+
+// drawing runs on its own thread (see the render loop in main); --single-thread keeps it on the main thread
+bool renderThreaded = true;
+TripleBuffer<RenderSnapshot> renderSnapshots;
+
+// --gpu-driven: cull and draw the scene with compute + multi-draw-indirect (GL 4.3, see gpu_driven.h)
+bool gpuDriven = false;
+
 // bloom stuff
 struct bloomMip
 {
@@ -213,7 +177,6 @@ bool bloomFBO::Init(unsigned int windowWidth, unsigned int windowHeight, unsigne
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
 
-        std::cout << "Created bloom mip " << mipIntSize.x << 'x' << mipIntSize.y << std::endl;
         mMipChain.emplace_back(mip);
     }
 
@@ -246,6 +209,7 @@ void bloomFBO::Destroy()
     }
     glDeleteFramebuffers(1, &mFBO);
     mFBO = 0;
+    mMipChain.clear();
     mInit = false;
 }
 
@@ -259,12 +223,15 @@ const std::vector<bloomMip>& bloomFBO::MipChain() const
     return mMipChain;
 }
 
+const unsigned int kNumBloomMips = 6; // TODO: Play around with this value
+
 class BloomRenderer
 {
 public:
     BloomRenderer();
     ~BloomRenderer();
     bool Init(unsigned int windowWidth, unsigned int windowHeight);
+    bool Resize(unsigned int windowWidth, unsigned int windowHeight);
     void Destroy();
     void RenderBloomTexture(unsigned int srcTexture, float filterRadius);
     unsigned int BloomTexture();
@@ -278,8 +245,8 @@ private:
     bloomFBO mFBO;
     glm::ivec2 mSrcViewportSize;
     glm::vec2 mSrcViewportSizeFloat;
-    Shader* mDownsampleShader;
-    Shader* mUpsampleShader;
+    CachedShader* mDownsampleShader;
+    CachedShader* mUpsampleShader;
 
     bool mKarisAverageOnDownsample = true;
 };
@@ -294,16 +261,15 @@ bool BloomRenderer::Init(unsigned int windowWidth, unsigned int windowHeight)
     mSrcViewportSizeFloat = glm::vec2((float)windowWidth, (float)windowHeight);
 
     // Framebuffer
-    const unsigned int num_bloom_mips = 6; // TODO: Play around with this value
-    bool status = mFBO.Init(windowWidth, windowHeight, num_bloom_mips);
+    bool status = mFBO.Init(windowWidth, windowHeight, kNumBloomMips);
     if (!status) {
         std::cerr << "Failed to initialize bloom FBO - cannot create bloom renderer!\n";
         return false;
     }
 
     // Shaders
-    mDownsampleShader = new Shader("6.new_downsample.vs", "6.new_downsample.fs");
-    mUpsampleShader = new Shader("6.new_upsample.vs", "6.new_upsample.fs");
+    mDownsampleShader = new CachedShader("6.new_downsample.vs", "6.new_downsample.fs");
+    mUpsampleShader = new CachedShader("6.new_upsample.vs", "6.new_upsample.fs");
 
     // Downsample
     mDownsampleShader->use();
@@ -315,9 +281,24 @@ bool BloomRenderer::Init(unsigned int windowWidth, unsigned int windowHeight)
     mUpsampleShader->setInt("srcTexture", 0);
     glUseProgram(0);
 
+    mInit = true;
     return true;
 }
 
+// rebuild the mip chain for a new source size, keeping the shaders
+bool BloomRenderer::Resize(unsigned int windowWidth, unsigned int windowHeight)
+{
+    mSrcViewportSize = glm::ivec2(windowWidth, windowHeight);
+    mSrcViewportSizeFloat = glm::vec2((float)windowWidth, (float)windowHeight);
+
+    mFBO.Destroy();
+    bool status = mFBO.Init(windowWidth, windowHeight, kNumBloomMips);
+    if (!status) {
+        std::cerr << "Failed to resize bloom FBO!\n";
+    }
+    return status;
+}
+
 void BloomRenderer::Destroy()
 {
     mFBO.Destroy();
@@ -416,6 +397,127 @@ GLuint BloomRenderer::BloomMip_i(int index)
     return mipChain[(index > size - 1) ? size - 1 : (index < 0) ? 0 : index].texture;
 }
 
+// owns every size-dependent target: the HDR scene buffer, its depth buffer and the bloom mip chain.
+// Targets are sized from the framebuffer size times a render scale and rebuilt on Resize().
+class RenderTargets
+{
+public:
+    RenderTargets();
+    ~RenderTargets();
+    bool Init(unsigned int width, unsigned int height);
+    bool Resize(unsigned int width, unsigned int height);
+    void Destroy();
+    void BindScene();
+    unsigned int SceneTexture() const;
+    glm::ivec2 Size() const;
+    BloomRenderer& Bloom();
+
+private:
+    bool createSceneTargets(unsigned int width, unsigned int height);
+    void destroySceneTargets();
+
+    bool mInit;
+    unsigned int mFBO;
+    unsigned int mColorBuffer;
+    unsigned int mRboDepth;
+    glm::ivec2 mSize;
+    BloomRenderer mBloom;
+};
+
+RenderTargets::RenderTargets() : mInit(false), mFBO(0), mColorBuffer(0), mRboDepth(0), mSize(0, 0) {}
+RenderTargets::~RenderTargets() {}
+
+bool RenderTargets::Init(unsigned int width, unsigned int height)
+{
+    if (mInit) return true;
+    if (!createSceneTargets(width, height))
+        return false;
+    if (!mBloom.Init(width, height))
+        return false;
+    mInit = true;
+    return true;
+}
+
+bool RenderTargets::Resize(unsigned int width, unsigned int height)
+{
+    // minimised windows report 0x0, keep the old targets until we're visible again
+    if (width == 0 || height == 0) return false;
+    if ((int)width == mSize.x && (int)height == mSize.y) return true;
+
+    destroySceneTargets();
+    if (!createSceneTargets(width, height))
+        return false;
+    return mBloom.Resize(width, height);
+}
+
+void RenderTargets::Destroy()
+{
+    destroySceneTargets();
+    mBloom.Destroy();
+    mInit = false;
+}
+
+bool RenderTargets::createSceneTargets(unsigned int width, unsigned int height)
+{
+    mSize = glm::ivec2(width, height);
+
+    glGenFramebuffers(1, &mFBO);
+    glBindFramebuffer(GL_FRAMEBUFFER, mFBO);
+    // create a floating point color buffer; bloom is extracted from it by the BloomRenderer mip chain
+    glGenTextures(1, &mColorBuffer);
+    glBindTexture(GL_TEXTURE_2D, mColorBuffer);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA16F, width, height, 0, GL_RGBA, GL_FLOAT, NULL);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR); // bilinear upscale in the final pass when render scale < 1
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);  // we clamp to the edge as the bloom downsample would otherwise sample repeated texture values!
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    // attach texture to framebuffer
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, mColorBuffer, 0);
+    // create and attach depth buffer (renderbuffer)
+    glGenRenderbuffers(1, &mRboDepth);
+    glBindRenderbuffer(GL_RENDERBUFFER, mRboDepth);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT, width, height);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, mRboDepth);
+    // tell OpenGL which color attachments we'll use (of this framebuffer) for rendering
+    unsigned int attachments[1] = { GL_COLOR_ATTACHMENT0 };
+    glDrawBuffers(1, attachments);
+    // finally check if framebuffer is complete
+    bool complete = glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+    if (!complete)
+        std::cout << "Framebuffer not complete!" << std::endl;
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    return complete;
+}
+
+void RenderTargets::destroySceneTargets()
+{
+    glDeleteFramebuffers(1, &mFBO);
+    glDeleteTextures(1, &mColorBuffer);
+    glDeleteRenderbuffers(1, &mRboDepth);
+    mFBO = mColorBuffer = mRboDepth = 0;
+}
+
+void RenderTargets::BindScene()
+{
+    glBindFramebuffer(GL_FRAMEBUFFER, mFBO);
+    glViewport(0, 0, mSize.x, mSize.y);
+}
+
+unsigned int RenderTargets::SceneTexture() const
+{
+    return mColorBuffer;
+}
+
+glm::ivec2 RenderTargets::Size() const
+{
+    return mSize;
+}
+
+BloomRenderer& RenderTargets::Bloom()
+{
+    return mBloom;
+}
+
 
 unsigned int quadVAO = 0;
 unsigned int quadVBO;
@@ -440,78 +542,49 @@ void drawCrosshair(float size = 20.0f, float lineWidth = 2.0f) {
     glEnd();
 }
 
-glm::vec3 hsv2rgb(float h, float s, float v)
-{
-    float c = v * s;
-    float x = c * (1.0f - fabsf(fmodf(h / 60.0f, 2.0f) - 1.0f));
-    float m = v - c;
-
-    float r, g, b;
-    if (h < 60.0f) { r = c; g = x; b = 0.0f; }
-    else if (h < 120.0f) { r = x; g = c; b = 0.0f; }
-    else if (h < 180.0f) { r = 0.0f; g = c; b = x; }
-    else if (h < 240.0f) { r = 0.0f; g = x; b = c; }
-    else if (h < 300.0f) { r = x; g = 0.0f; b = c; }
-    else { r = c; g = 0.0f; b = x; }
-
-    return glm::vec3(r + m, g + m, b + m);
-}
-
-glm::vec3 randomBrightColor()
-{
-    float h = randomFloat(0.0f, 360.0f);
-    float s = 0.9f;
-    float v = 1.0f;
-    return hsv2rgb(h, s, v);
-}
-
 // Stage control variables
 int currentStage = 1;
 float stageTimer = 0.0f;
 float stageDuration = 20.0f;
 
-void respawnEnemy(Enemy& e)
-{
-    float x = randomFloat(-4.0f, 4.0f);
-    float y = randomFloat(2.0f, 6.0f);
-    float z = randomFloat(-30.0f, -15.0f);
-
-    e.position = glm::vec3(x, y, z);
-    e.state = ENEMY_ALIVE;
-    e.alive = true;
-    e.deathT = 0.0f;
-    e.flashT = 0.0f;
-    e.color = randomBrightColor();
-}
-
 void resetGame()
 {
-    // reset player
-    playerHealth = playerMaxHealth;
-    playerScore = 0;
-    playerPosition = glm::vec3(0.0f, -0.8f, 3.0f);
-    playerFlashT = 0.0f;
-
-    // clear bullets
-    bullets.clear();
-    enemyBullets.clear();
-
-    // respawn all enemies
-    for (Enemy& e : enemies) {
-        respawnEnemy(e);
-    }
-
-    timeSinceLastShot = 0.0f;
-    timeSinceLastEnemyShot = 0.0f;
+    // reset player, clear bullets and respawn all enemies
+    world.Reset();
+    inputRecorder.Reset();
 
     // go back to start screen (or set GAME_PLAYING if you want immediate restart)
     gameState = GAME_START;
 }
 
-int main()
+int main(int argc, char** argv)
 {
+    // command line: [--seed <n>] [--record <replay file>] [--sim-hz <rate>] [--single-thread] [--stress <enemies>]
+    //               [--audio irrklang|null|wav:<file>] [--gpu-driven]
+    uint64_t seed = static_cast<uint64_t>(std::time(nullptr));
+    const char* recordPath = nullptr;
+    int stressEnemies = 0;
+    std::string audioBackend = "irrklang";
+    for (int i = 1; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if (std::strcmp(argv[i], "--single-thread") == 0)
+            renderThreaded = false;
+        else if (std::strcmp(argv[i], "--gpu-driven") == 0)
+            gpuDriven = true;
+        else if (hasValue && std::strcmp(argv[i], "--seed") == 0)
+            seed = std::strtoull(argv[++i], nullptr, 10);
+        else if (hasValue && std::strcmp(argv[i], "--record") == 0)
+            recordPath = argv[++i];
+        else if (hasValue && std::strcmp(argv[i], "--stress") == 0)
+            stressEnemies = std::max(0, std::atoi(argv[++i]));
+        else if (hasValue && std::strcmp(argv[i], "--sim-hz") == 0)
+            simHz = glm::clamp((float)std::atof(argv[++i]), 10.0f, 1000.0f);
+        else if (hasValue && std::strcmp(argv[i], "--audio") == 0)
+            audioBackend = argv[++i];
+    }
+
     glfwInit();
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, gpuDriven ? 4 : 3);
     glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
     glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
 
@@ -520,6 +593,13 @@ int main()
 #endif
 
     GLFWwindow* window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, "LearnOpenGL", NULL, NULL);
+    if (window == NULL && gpuDriven)
+    {
+        std::cout << "No OpenGL 4.3 context, --gpu-driven disabled" << std::endl;
+        gpuDriven = false;
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+        window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, "LearnOpenGL", NULL, NULL);
+    }
     if (window == NULL)
     {
         std::cout << "Failed to create GLFW window" << std::endl;
@@ -541,28 +621,113 @@ int main()
         std::cout << "Failed to initialize GLAD" << std::endl;
         return -1;
     }
-    gSound = createIrrKlangDevice();
-    if (!gSound) {
-        std::cerr << "Failed to create irrKlang device\n";
+
+    // load textures
+    // -------------
+    // decoding runs on worker threads while sound, shaders and models load below;
+    // the pixels are uploaded by textureLoader.Finish() further down
+    TextureLoader textureLoader;
+    unsigned int containerTexture = textureLoader.Texture2D(FileSystem::getPath("resources/textures/container2.png"), true); // note that we're loading the texture as an SRGB texture
+    crosshairTexture = textureLoader.Texture2D(FileSystem::getPath("resources/textures/crosshair.png"), true);
+
+    std::vector<std::string> faces
+    {
+        FileSystem::getPath("resources/textures/nightskybox/right.png"),
+        FileSystem::getPath("resources/textures/nightskybox/left.png"),
+        FileSystem::getPath("resources/textures/nightskybox/top.png"),
+        FileSystem::getPath("resources/textures/nightskybox/bottom.png"),
+        FileSystem::getPath("resources/textures/nightskybox/front.png"),
+        FileSystem::getPath("resources/textures/nightskybox/back.png"),
+    };
+    unsigned int cubemapTexture = textureLoader.Cubemap(faces);
+
+    // wav:<file> mixes offline into <file> (in game time), null plays nothing
+    std::unique_ptr<AudioBackend> audio;
+    if (audioBackend == "null") {
+        audio.reset(new NullAudio());
+    }
+    else if (audioBackend.compare(0, 4, "wav:") == 0) {
+        audio.reset(new WavFileAudio(audioBackend.substr(4)));
     }
     else {
-        const std::string musicPath = FileSystem::getPath("resources/audio/bg.mp3");
-        gSound->play2D(musicPath.c_str(), /*looped=*/true, /*startPaused=*/false, /*track=*/false);
-
+        IrrKlangAudio* device = new IrrKlangAudio();
+        audio.reset(device);
+        if (!device->Init()) {
+            std::cerr << "Failed to create irrKlang device\n";
+            audio.reset(new NullAudio());
+        }
     }
+    const int music = audio->Load(FileSystem::getPath("resources/audio/bg.mp3"), /*stream=*/true);
+    audio->Play(music, 1.0f, /*looped=*/true);
+    gSfx.Init(audio.get());
+    // below full volume so a burst of hits in one flush can play louder
+    const float kSfxVolume = 0.6f;
+    const int sfxHit = gSfx.Load(FileSystem::getPath("resources/audio/hit.wav"), 4, kSfxVolume);
+    const int sfxDamage = gSfx.Load(FileSystem::getPath("resources/audio/damage.wav"), 2, kSfxVolume);
 
     glEnable(GL_DEPTH_TEST);
-    Shader skyboxShader("6.sky_box.vs", "6.sky_box.fs");
-    Shader shader("6.bloom.vs", "6.bloom.fs");
-    Shader shaderBloomFinal("6.bloom_final.vs", "6.bloom_final.fs");
-    Shader crosshairShader("crosshair.vs", "crosshair.fs");
-    Shader textShader("text.vs", "text.fs");
-    Model ufoModel = Model(FileSystem::getPath("resources/objects/ufo/SpaceShip.dae"));
-    Model playerModel = Model(FileSystem::getPath("resources/objects/ufo/Rocket.dae"));
-    Model bulletModel = Model(FileSystem::getPath("resources/objects/ufo/9mm.dae"));
-    const std::string playerHitPath = FileSystem::getPath("resources/audio/damage.wav");
-
-    std::srand(static_cast<unsigned>(std::time(nullptr)));
+    CachedShader skyboxShader("6.sky_box.vs", "6.sky_box.fs");
+    // 6.bloom.fs and 6.bloom_final.fs are specialized with #defines instead of branching per fragment:
+    // lit for the scene's light count, tint-only for bullets, and one tone-map program per bloom mode
+    const unsigned int kSceneLights = 1; // the camera light
+    const std::vector<std::string> litDefines = { "NUM_LIGHTS " + std::to_string(kSceneLights) };
+    CachedShader shader("6.bloom.vs", "6.bloom.fs", nullptr, litDefines);
+    CachedShader tintShader("6.bloom.vs", "6.bloom.fs", nullptr, { "TINT_ONLY" });
+    std::vector<std::unique_ptr<CachedShader>> bloomFinalShaders;
+    for (int mode = 1; mode <= kBloomModes; mode++)
+        bloomFinalShaders.emplace_back(new CachedShader("6.bloom_final.vs", "6.bloom_final.fs", nullptr,
+            { "BLOOM_MODE " + std::to_string(mode) }));
+    CachedShader crosshairShader("crosshair.vs", "crosshair.fs");
+    CachedShader textShader("text.vs", "text.fs");
+
+    // camera, light and HUD matrices shared by all programs through one uniform buffer
+    PerFrameBuffer perFrameBuffer;
+    perFrameBuffer.Init();
+    PerFrameBuffer::Attach(shader);
+    PerFrameBuffer::Attach(tintShader);
+    PerFrameBuffer::Attach(skyboxShader);
+    PerFrameBuffer::Attach(textShader);
+    PerFrameUniforms perFrame;
+    // Assimp runs only on the first launch (or after the .dae changes); later launches map the .cooked files.
+    // Their textures go through textureLoader with the rest, so they are compressed, cached and uploaded by Finish()
+    CookedModel ufoModel(FileSystem::getPath("resources/objects/ufo/SpaceShip.dae"), false, &textureLoader);
+    CookedModel playerModel(FileSystem::getPath("resources/objects/ufo/Rocket.dae"), false, &textureLoader);
+    CookedModel bulletModel(FileSystem::getPath("resources/objects/ufo/9mm.dae"), false, &textureLoader);
+    // enemies are drawn from simplified copies of the UFO once they get small on screen
+    LodModel ufoLods(ufoModel.meshes);
+    const BoundingSphere bulletBounds = meshBounds(bulletModel.meshes);
+    // per-frame instance buffers, one instanced draw per mesh (and UFO LOD) for all bullets / all enemies
+    std::vector<std::unique_ptr<InstancedModel>> ufoInstances;
+    for (int level = 0; level < LodModel::kLevels; level++)
+        ufoInstances.emplace_back(new InstancedModel(ufoLods.Level(level)));
+    InstancedModel bulletInstances(bulletModel.meshes);
+    InstancedModel playerInstances(playerModel.meshes);
+    // every scene draw goes through the queue, sorted so shared program / texture / VAO binds happen once
+    GLStateCache glState;
+    RenderQueue renderQueue(glState);
+
+    // --gpu-driven: the same models packed into shared buffers, culled and LOD-picked by a compute pass
+    GpuDrivenScene gpuScene;
+    int gpuPlayer = -1, gpuBullet = -1, gpuUfo = -1;
+    if (gpuDriven && !GpuDrivenScene::Supported()) {
+        std::cout << "OpenGL 4.3 entry points or vertex-stage storage buffers missing, --gpu-driven disabled" << std::endl;
+        gpuDriven = false;
+    }
+    if (gpuDriven) {
+        gpuPlayer = gpuScene.AddModel(playerModel.meshes, meshBounds(playerModel.meshes), false);
+        gpuBullet = gpuScene.AddModel(bulletModel.meshes, bulletBounds, true);
+        // UFO levels chain to the coarser one below the same thresholds as LodModel::SelectLevel
+        int ufoLod2 = gpuScene.AddModel(ufoLods.Level(2), ufoLods.Bounds, false);
+        int ufoLod1 = gpuScene.AddModel(ufoLods.Level(1), ufoLods.Bounds, false, LodModel::kLod2Pixels, ufoLod2);
+        gpuUfo = gpuScene.AddModel(ufoLods.Level(0), ufoLods.Bounds, false, LodModel::kLod1Pixels, ufoLod1);
+        gpuDriven = gpuScene.Build("gpu_cull.cs", "gpu_scene.vs", "6.bloom.fs", litDefines);
+        if (gpuDriven) {
+            PerFrameBuffer::Attach(gpuScene.DrawShader(false));
+            PerFrameBuffer::Attach(gpuScene.DrawShader(true));
+        } else {
+            std::cout << "GPU-driven shaders failed to build, --gpu-driven disabled" << std::endl;
+        }
+    }
 
     unsigned int skyboxVAO, skyboxVBO;
     float skyboxVertices[] = {
@@ -617,488 +782,171 @@ int main()
     glBufferData(GL_ARRAY_BUFFER, sizeof(skyboxVertices), &skyboxVertices, GL_STATIC_DRAW);
     glEnableVertexAttribArray(0);
     glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
-    // load textures
-    // -------------
-    unsigned int woodTexture = loadTexture(FileSystem::getPath("resources/textures/wood.png").c_str(), true); // note that we're loading the texture as an SRGB texture
-    unsigned int containerTexture = loadTexture(FileSystem::getPath("resources/textures/container2.png").c_str(), true); // note that we're loading the texture as an SRGB texture
-
-    crosshairTexture = loadTexture(FileSystem::getPath("resources/textures/crosshair.png").c_str(), true);
-    if (crosshairTexture == 0) {
-        std::cerr << "Failed to load crosshair texture!" << std::endl;
-    }
-
-    std::vector<std::string> faces
-    {
-        FileSystem::getPath("resources/textures/nightskybox/right.png"),
-        FileSystem::getPath("resources/textures/nightskybox/left.png"),
-        FileSystem::getPath("resources/textures/nightskybox/top.png"),
-        FileSystem::getPath("resources/textures/nightskybox/bottom.png"),
-        FileSystem::getPath("resources/textures/nightskybox/front.png"),
-        FileSystem::getPath("resources/textures/nightskybox/back.png"),
-    };
-    unsigned int cubemapTexture = loadCubemap(faces);
+    // finish texture uploads, showing a loading bar until every image is on the GPU
+    // ------------------------------------------------------------------------------
+    textureLoader.Finish([&](int uploaded, int queued) {
+        glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        crosshairShader.use();
+        crosshairShader.setVec3("color", glm::vec3(0.0f));
+        renderHealthBar(1.0f, false);
+        crosshairShader.setVec3("color", glm::vec3(1.0f));
+        renderHealthBar(queued > 0 ? (float)uploaded / queued : 1.0f, true);
+        glfwSwapBuffers(window);
+        glfwPollEvents();
+    });
     skyboxShader.use();
     skyboxShader.setInt("skybox", 0);
-    // configure (floating point) framebuffers
-    // ---------------------------------------
-    unsigned int hdrFBO;
-    glGenFramebuffers(1, &hdrFBO);
-    glBindFramebuffer(GL_FRAMEBUFFER, hdrFBO);
-    // create 2 floating point color buffers (1 for normal rendering, other for brightness threshold values)
-    unsigned int colorBuffers[2];
-    glGenTextures(2, colorBuffers);
-    for (unsigned int i = 0; i < 2; i++)
-    {
-        glBindTexture(GL_TEXTURE_2D, colorBuffers[i]);
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA16F, SCR_WIDTH, SCR_HEIGHT, 0, GL_RGBA, GL_FLOAT, NULL);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);  // we clamp to the edge as the blur filter would otherwise sample repeated texture values!
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-        // attach texture to framebuffer
-        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0 + i, GL_TEXTURE_2D, colorBuffers[i], 0);
-    }
-    // create and attach depth buffer (renderbuffer)
-    unsigned int rboDepth;
-    glGenRenderbuffers(1, &rboDepth);
-    glBindRenderbuffer(GL_RENDERBUFFER, rboDepth);
-    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT, SCR_WIDTH, SCR_HEIGHT);
-    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, rboDepth);
-    // tell OpenGL which color attachments we'll use (of this framebuffer) for rendering
-    unsigned int attachments[2] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1 };
-    glDrawBuffers(2, attachments);
-    // finally check if framebuffer is complete
-    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
-        std::cout << "Framebuffer not complete!" << std::endl;
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
-
-    // ping-pong-framebuffer for blurring
-    unsigned int pingpongFBO[2];
-    unsigned int pingpongColorbuffers[2];
-    glGenFramebuffers(2, pingpongFBO);
-    glGenTextures(2, pingpongColorbuffers);
-    for (unsigned int i = 0; i < 2; i++)
-    {
-        glBindFramebuffer(GL_FRAMEBUFFER, pingpongFBO[i]);
-        glBindTexture(GL_TEXTURE_2D, pingpongColorbuffers[i]);
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA16F, SCR_WIDTH, SCR_HEIGHT, 0, GL_RGBA, GL_FLOAT, NULL);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE); // we clamp to the edge as the blur filter would otherwise sample repeated texture values!
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, pingpongColorbuffers[i], 0);
-        // also check if framebuffers are complete (no need for depth buffer)
-        if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
-            std::cout << "Framebuffer not complete!" << std::endl;
-    }
-
 
     // shader configuration
     // --------------------
     shader.use();
     shader.setInt("diffuseTexture", 0);
-    shaderBloomFinal.use();
-    shaderBloomFinal.setInt("scene", 0);
-    shaderBloomFinal.setInt("bloomBlur", 1);
+    for (auto& bloomFinal : bloomFinalShaders) {
+        bloomFinal->use();
+        bloomFinal->setInt("scene", 0);
+        bloomFinal->setInt("bloomBlur", 1);
+    }
     crosshairShader.use();
     crosshairShader.setInt("crosshairTex", 0);
 
-    // bloom renderer
-    // --------------
-    BloomRenderer bloomRenderer;
-    bloomRenderer.Init(SCR_WIDTH, SCR_HEIGHT);
+    // configure (floating point) framebuffers + bloom renderer
+    // -------------------------------------------------------
+    // the framebuffer can be larger than the window on HiDPI displays
+    glfwGetFramebufferSize(window, &framebufferWidth, &framebufferHeight);
+    RenderTargets renderTargets;
+    renderTargets.Init(framebufferWidth, framebufferHeight);
+    if (ProgramBinaryCache::Enabled())
+        std::cout << "Shader programs: " << ProgramBinaryCache::Hits() << " from the binary cache, "
+                  << ProgramBinaryCache::Misses() << " compiled" << std::endl;
 
     // Initialize enemies with random positions instead of fixed grid
-    for (int i = 0; i < 15; ++i)
-    {
-        Enemy e;
-        respawnEnemy(e);
-        enemies.push_back(e);
+    // (re-rolled here so the seed above is actually used)
+    if (stressEnemies > 0)
+        world = World(stressEnemies, kDefaultBulletCapacity, seed);
+    world.Seed(seed);
+    world.Reset();
+    // spread the per-entity update over the cores, leaving one for the render thread
+    unsigned int cores = std::thread::hardware_concurrency();
+    JobSystem simJobs(cores > 2 ? cores - 1 : 1);
+    world.SetJobSystem(&simJobs);
+    if (recordPath) {
+        if (inputRecorder.Open(recordPath, seed, world))
+            std::cout << "Recording input to " << recordPath << " (seed " << seed << ")" << std::endl;
+        else
+            std::cout << "Failed to open replay file " << recordPath << std::endl;
     }
 
     // ================== FreeType text init ==================
-    FT_Library ft;
-    if (FT_Init_FreeType(&ft)) {
-        std::cout << "ERROR::FREETYPE: Could not init FreeType Library\n";
-    }
-
-    FT_Face face;
-    if (FT_New_Face(ft,
-        FileSystem::getPath("resources/fonts/OCRAEXT.ttf").c_str(),
-        0,
-        &face))
-    {
-        std::cout << "ERROR::FREETYPE: Failed to load font\n";
-    }
-
-    FT_Set_Pixel_Sizes(face, 0, 48);  // 48 px font size
-
-    glPixelStorei(GL_UNPACK_ALIGNMENT, 1); // disable byte-alignment restriction
+    // all glyphs go into one atlas texture; HUD strings are batched into a single draw per frame
+    TextRenderer hudText;
+    if (!hudText.Init(FileSystem::getPath("resources/fonts/OCRAEXT.ttf"), 48))  // 48 px font size
+        std::cout << "ERROR::FREETYPE: Failed to build glyph atlas\n";
 
-    for (unsigned char c = 0; c < 128; c++) {
-        // Load character glyph
-        if (FT_Load_Char(face, c, FT_LOAD_RENDER)) {
-            std::cout << "ERROR::FREETYPE: Failed to load Glyph\n";
-            continue;
-        }
-
-        unsigned int texture;
-        glGenTextures(1, &texture);
-        glBindTexture(GL_TEXTURE_2D, texture);
-        glTexImage2D(
-            GL_TEXTURE_2D,
-            0,
-            GL_RED,
-            face->glyph->bitmap.width,
-            face->glyph->bitmap.rows,
-            0,
-            GL_RED,
-            GL_UNSIGNED_BYTE,
-            face->glyph->bitmap.buffer
-        );
-
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-        Character character = {
-            texture,
-            glm::ivec2(face->glyph->bitmap.width, face->glyph->bitmap.rows),
-            glm::ivec2(face->glyph->bitmap_left,  face->glyph->bitmap_top),
-            static_cast<unsigned int>(face->glyph->advance.x)
-        };
-        Characters.insert(std::pair<char, Character>(c, character));
-    }
-
-    FT_Done_Face(face);
-    FT_Done_FreeType(ft);
-
-    // Text rendering VAO/VBO
-    glGenVertexArrays(1, &textVAO);
-    glGenBuffers(1, &textVBO);
-    glBindVertexArray(textVAO);
-    glBindBuffer(GL_ARRAY_BUFFER, textVBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(float) * 6 * 4, NULL, GL_DYNAMIC_DRAW);
-    // (x, y, u, v)
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)0);
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindVertexArray(0);
-
-    // projection matrix for text (pixel coords)
-    glm::mat4 textProjection = glm::ortho(
+    // projection matrix for text (pixel coords), uploaded with the per-frame uniforms
+    perFrame.hudProjection = glm::ortho(
         0.0f, static_cast<float>(SCR_WIDTH),
         0.0f, static_cast<float>(SCR_HEIGHT)
     );
     textShader.use();
-    textShader.setMat4("projection", textProjection);
     textShader.setInt("text", 0);
 
 
     // render loop
     // -----------
-    while (!glfwWindowShouldClose(window))
-    {
-        // per-frame time logic
-        float currentFrame = static_cast<float>(glfwGetTime());
-        deltaTime = currentFrame - lastFrame;
-        lastFrame = currentFrame;
-
-        // input
-        processInput(window);
-
-        // Make camera follow player (stick behind)
-        camera.Position = playerPosition + glm::vec3(0.0f, 0.75f, 1.0f);
+    // This thread polls events, runs the simulation and publishes a RenderSnapshot each
+    // iteration; the render thread owns the GL context and draws the newest one. With
+    // --single-thread the snapshot is drawn inline instead.
+    auto renderFrame = [&](const RenderSnapshot& snap) {
+        profiler.BeginFrame();
 
-        // render
         glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-        // ---------- GAME LOGIC: only run when playing ----------
-        if (gameState == GAME_PLAYING) {
-            timeSinceLastShot += deltaTime;
-            timeSinceLastEnemyShot += deltaTime;
-
-            // ---- player bullets spawn + movement ----
-            if (timeSinceLastShot >= shootCooldown)
-            {
-                Bullet b;
-                b.position = playerPosition + glm::vec3(0.0f, 0.2f, 0.0f);
-                b.direction = glm::normalize(camera.Front);
-                b.speed = 10.0f;
-                bullets.push_back(b);
-                timeSinceLastShot = 0.0f;
-            }
-
-            for (int i = 0; i < bullets.size(); )
-            {
-                bullets[i].position += bullets[i].direction * bullets[i].speed * deltaTime;
-                if (bullets[i].position.y > 5.0f)
-                    bullets.erase(bullets.begin() + i);
-                else
-                    i++;
-            }
-
-            // ---- enemy bullets update + hit player ----
-            for (int i = 0; i < (int)enemyBullets.size(); )
-            {
-                enemyBullets[i].position += enemyBullets[i].direction * enemyBullets[i].speed * deltaTime;
-
-                if (enemyBullets[i].position.z > 10.0f || enemyBullets[i].position.z < -60.0f) {
-                    enemyBullets.erase(enemyBullets.begin() + i);
-                    continue;
-                }
-
-                float distToPlayer = glm::length(enemyBullets[i].position - playerPosition);
-                if (distToPlayer < 0.5f) {
-                    if (gSound) gSound->play2D(playerHitPath.c_str(), false);
-
-                    playerFlashT = kPlayerFlashDur;
-                    playerHealth -= 10.0f;
-                    if (playerHealth < 0.0f) playerHealth = 0.0f;
-
-                    enemyBullets.erase(enemyBullets.begin() + i);
-                }
-                else {
-                    ++i;
-                }
-            }
-
-            const std::string hitPath = FileSystem::getPath("resources/audio/hit.wav");
-            // ---- player bullets hit enemies ----
-            for (Bullet& b : bullets) {
-                for (Enemy& e : enemies) {
-                    if (!e.alive) continue;
-                    float dist = glm::length(b.position - e.position);
-                    if (dist < 0.5f) {
-                        if (e.state == ENEMY_ALIVE) {
-                            e.state = ENEMY_DYING;
-                            e.deathT = 0.0f;
-                            e.flashT = kFlashDur;
-                            if (gSound) gSound->play2D(hitPath.c_str(), false);
-                            playerScore += 5;
-                        }
-                        b.position.y = 9999.0f;
-                    }
-                }
-            }
-
-            // ---- Remove bullets that hit enemies / went too far ----
-            for (int i = 0; i < bullets.size();) {
-                if (bullets[i].position.y > 5.0f || bullets[i].position.y > 100.0f)
-                    bullets.erase(bullets.begin() + i);
-                else
-                    i++;
-            }
-
-            // ---- Enemy movement ----
-            float leftLimit = -5.0f;
-            float rightLimit = 5.0f;
-            float moveSpeed = 2.5f;
-            glm::vec3 moveDir = glm::normalize(glm::vec3(0.0f, -0.3f, 1.0f));
-
-            for (Enemy& e : enemies) {
-                if (!e.alive && e.state == ENEMY_DEAD) {
-                    respawnEnemy(e);
-                    continue;
-                }
-                if (!e.alive) continue;
-                e.position += moveDir * moveSpeed * deltaTime;
-                e.position.x += sin(glfwGetTime() + e.position.z) * 0.002f;
-                if (e.position.z > playerPosition.z + 1.0f) {
-                    respawnEnemy(e);
-                }
-            }
-
-            // ---- Enemy shooting ----
-            if (timeSinceLastEnemyShot >= enemyShootCooldown) {
-                std::vector<int> aliveIndices;
-                for (int i = 0; i < (int)enemies.size(); ++i) {
-                    if (enemies[i].alive && enemies[i].state == ENEMY_ALIVE) {
-                        aliveIndices.push_back(i);
-                    }
-                }
-
-                if (!aliveIndices.empty()) {
-                    int idx = aliveIndices[rand() % aliveIndices.size()];
-                    Enemy& shooter = enemies[idx];
-
-                    Bullet b;
-                    b.position = shooter.position;
-                    b.direction = glm::normalize(playerPosition - shooter.position);
-                    b.speed = 8.0f;
-                    enemyBullets.push_back(b);
-                }
-
-                timeSinceLastEnemyShot = 0.0f;
-            }
-
-            // ---- Enemyplayer collision ----
-            for (Enemy& e : enemies) {
-                if (!e.alive) continue;
-
-                float distToPlayer = glm::length(e.position - playerPosition);
-                if (distToPlayer < 0.7f) {
-                    if (gSound) gSound->play2D(playerHitPath.c_str(), false);
-
-                    playerFlashT = kPlayerFlashDur;
-                    playerHealth -= 20.0f;
-                    if (playerHealth < 0.0f) playerHealth = 0.0f;
-
-                    respawnEnemy(e);
-                }
-            }
-
-            // ---- Edge bounce ----
-            bool bounce = false;
-            for (const Enemy& e : enemies) {
-                if (!e.alive) continue;
-                if ((moveRight && e.position.x > rightLimit) ||
-                    (!moveRight && e.position.x < leftLimit)) {
-                    bounce = true;
-                    break;
-                }
-            }
-            if (bounce) {
-                moveRight = !moveRight;
-                for (Enemy& e : enemies) {
-                    e.position.y -= enemyStepDown;
-                }
-            }
-
-            // ---- Flash / death timers ----
-            for (Enemy& e : enemies) {
-                if (e.flashT > 0.0f) {
-                    e.flashT = std::max(0.0f, e.flashT - deltaTime);
-                }
-                if (e.state == ENEMY_DYING) {
-                    e.deathT += deltaTime;
-                    if (e.deathT >= 0.35f) {
-                        e.state = ENEMY_DEAD;
-                        e.alive = false;
-                    }
-                }
-            }
-
-            if (playerFlashT > 0.0f) {
-                playerFlashT = std::max(0.0f, playerFlashT - deltaTime);
-            }
-            // ---- Check for game over ----
-            if (playerHealth <= 0.0f) {
-                playerHealth = 0.0f;
-                gameState = GAME_OVER;
-            }
-
-        } // <-- NOW this closes AFTER all movement/shooting/collisions
-
-
-
-
         // 1. render scene into floating point framebuffer
         // -----------------------------------------------
-        glBindFramebuffer(GL_FRAMEBUFFER, hdrFBO);
+        profiler.BeginZone("scene", true);
+        renderTargets.Resize((unsigned int)(snap.framebufferWidth * snap.renderScale), (unsigned int)(snap.framebufferHeight * snap.renderScale));
+        renderTargets.BindScene();
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-        glm::mat4 projection = glm::perspective(glm::radians(camera.Zoom), (float)SCR_WIDTH / (float)SCR_HEIGHT, 0.1f, 100.0f);
-        glm::mat4 view = camera.GetViewMatrix();
-        glm::mat4 model = glm::mat4(1.0f);
-        shader.use();
-        shader.setMat4("projection", projection);
-        shader.setMat4("view", view);
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, woodTexture);
-        // Simple camera light
-        shader.setVec3("lights[0].Position", camera.Position);
-        shader.setVec3("lights[0].Color", glm::vec3(100.0f, 100.0f, 100.0f)); // bright white
+        float aspect = (snap.framebufferHeight > 0) ? (float)snap.framebufferWidth / (float)snap.framebufferHeight : (float)SCR_WIDTH / (float)SCR_HEIGHT;
+        glm::mat4 projection = glm::perspective(glm::radians(snap.fovDegrees), aspect, 0.1f, 100.0f);
+        glm::mat4 view = snap.view;
+        // bullets and enemies outside this are skipped before they reach an instance buffer
+        const Frustum frustum(projection * view);
+        const float sceneHeight = snap.framebufferHeight * snap.renderScale;
+
+        perFrame.projection = projection;
+        perFrame.view = view;
+        perFrame.viewPos = glm::vec4(snap.cameraPosition, 1.0f);
+        // Simple camera light (kSceneLights must match the lights set here)
+        for (unsigned int i = 0; i < kMaxLights; i++) {
+            perFrame.lightPositions[i] = glm::vec4(0.0f);
+            perFrame.lightColors[i] = glm::vec4(0.0f);
+        }
+        perFrame.lightPositions[0] = glm::vec4(snap.cameraPosition, 1.0f);
+        perFrame.lightColors[0] = glm::vec4(100.0f, 100.0f, 100.0f, 0.0f); // bright white
+        perFrameBuffer.Update(perFrame);
 
-        shader.setVec3("viewPos", camera.Position);
-        glBindTexture(GL_TEXTURE_2D, containerTexture);
+        glState.ResetCounters();
 
         // Draw player
         glm::vec3 playerColor(0.1f, 0.4f, 0.8f);
-        shader.use();
-        shader.setVec3("enemyColor", playerColor);
-        float playerFlash = (playerFlashT > 0.0f)
-            ? (playerFlashT / kPlayerFlashDur) * kPlayerFlashBoost
-            : 0.0f;
-        shader.setFloat("hitFlash", playerFlash);
 
         glm::mat4 playerModelMatrix = glm::mat4(1.0f);
-        playerModelMatrix = glm::translate(playerModelMatrix, playerPosition);
+        playerModelMatrix = glm::translate(playerModelMatrix, snap.playerPosition);
         playerModelMatrix = glm::scale(playerModelMatrix, glm::vec3(0.30f));
         playerModelMatrix = glm::rotate(playerModelMatrix, glm::radians(180.0f), glm::vec3(1.0f, 0.0f, 0.0f));
         playerModelMatrix = glm::rotate(playerModelMatrix, glm::radians(90.0f), glm::vec3(0.0f, 1.0f, 0.0f));
         playerModelMatrix = glm::rotate(playerModelMatrix, glm::radians(0.0f), glm::vec3(0.0f, 0.0f, 1.0f));
 
-        glBindTexture(GL_TEXTURE_2D, containerTexture);
-        shader.setMat4("model", playerModelMatrix);
-        playerModel.Draw(shader);
-
-
-        // Draw bullets
-        shader.use();
-        shader.setBool("useTintOnly", true); 
-        shader.setBool("hasTexture", false);
-        //shader.setVec3("enemyColor", glm::vec3(1.0f));
-        shader.setVec3("enemyColor", glm::vec3(0.5f, 0.5f, 0.0f));
-
-        for (const Bullet& b : bullets) {
+        gpuScene.Clear();
+        playerInstances.Clear();
+        if (gpuDriven)
+            gpuScene.Add(gpuPlayer, playerModelMatrix, playerColor, snap.playerFlash);
+        else
+            playerInstances.Add(playerModelMatrix, playerColor, snap.playerFlash);
+
+        // Draw bullets (player + enemy share the bullet mesh, one tint-only instanced draw)
+        bulletInstances.Clear();
+        auto addBullet = [&](const glm::mat4& M, const glm::vec3& color) {
+            if (gpuDriven)
+                gpuScene.Add(gpuBullet, M, color, 0.0f); // culled on the GPU
+            else if (frustum.Intersects(transformSphere(bulletBounds, M)))
+                bulletInstances.Add(M, color, 0.0f);
+        };
+        for (const glm::vec3& p : snap.playerBullets) {
             glm::mat4 M = glm::mat4(1.0f);
-            M = glm::translate(M, b.position);
-            // Make the model face its flight direction
-            glm::vec3 d = glm::normalize(b.direction);
-            float yaw = std::atan2(d.x, d.z);
-            float pitch = std::asin(-d.y);
+            M = glm::translate(M, p);
             M *= glm::rotate(glm::mat4(1), glm::radians(90.0f), glm::vec3(0, 1, 0));
 
             // Scale to size that fits your scene
             M = glm::scale(M, glm::vec3(0.001f));   // tweak as needed
-            shader.setMat4("model", M);
-            // Important: don't bind containerTexture herelet Model::Draw handle textures
-            bulletModel.Draw(shader);
+            addBullet(M, glm::vec3(0.5f, 0.5f, 0.0f));
         }
-        shader.setBool("useTintOnly", false);
 
-        shader.setBool("useTintOnly", true);
-        shader.setBool("hasTexture", true);
-        shader.setVec3("enemyColor", glm::vec3(1.0f, 0.13f, 0.05f));
-
-        for (const Bullet& b : enemyBullets) {
+        for (const glm::vec3& p : snap.enemyBullets) {
             glm::mat4 M = glm::mat4(1.0f);
-            M = glm::translate(M, b.position);
-
-            glm::vec3 d = glm::normalize(b.direction);
-            float yaw = std::atan2(d.x, d.z);
-            float pitch = std::asin(-d.y);
+            M = glm::translate(M, p);
             M *= glm::rotate(glm::mat4(1), glm::radians(270.0f), glm::vec3(0, 1, 0));
 
             M = glm::scale(M, glm::vec3(0.005f));
-            shader.setMat4("model", M);
-            bulletModel.Draw(shader);
+            addBullet(M, glm::vec3(1.0f, 0.13f, 0.05f));
         }
-        shader.setBool("hasTexture", true);
-        shader.setBool("useTintOnly", false);
-
-
-
-        glm::vec3 aliveColor(1.0f, 0.0f, 0.0f); // normal enemy color
-        glm::vec3 dyingColor(1.0f, 0.8f, 0.2f); // warm flash when dying
-        for (const Enemy& e : enemies) {
-            // Skip only if fully dead; allow ENEMY_DYING to draw
-            if (!e.alive && e.state != ENEMY_DYING) continue;
 
+        for (auto& lod : ufoInstances)
+            lod->Clear();
+        for (const EnemyDraw& e : snap.enemies) {
             glm::mat4 enemyModel = glm::mat4(1.0f);
             enemyModel = glm::translate(enemyModel, e.position);
 
             float scale = 0.25f;   // your base scale
             float spinDeg = 0.0f;
-            float flash = 0.0f;
 
-            if (e.state == ENEMY_DYING) {
-                float t = glm::clamp(e.deathT / 0.35f, 0.0f, 1.0f);
+            if (e.dying >= 0.0f) {
+                float t = e.dying;
                 scale = glm::mix(0.25f, 0.0f, t);   // shrink to zero
                 spinDeg = 720.0f * t;                 // fast spin
-                flash = (1.0f - t) * 1.4f;          // emissive flash
                 enemyModel = glm::translate(enemyModel, glm::vec3(0.0f, 0.15f * (1.0f - t), 0.0f));
             }
 
@@ -1107,65 +955,92 @@ int main()
             enemyModel = glm::rotate(enemyModel, glm::radians(spinDeg), glm::vec3(0, 1, 0));
             enemyModel = glm::scale(enemyModel, glm::vec3(scale));
 
-            shader.use();
-            shader.setMat4("model", enemyModel);
-            // flash goes from kFlashBoost -> 0 over kFlashDur
-            float flash1 = (e.flashT > 0.0f) ? (e.flashT / kFlashDur) * kFlashBoost : 0.0f;
-            shader.setFloat("hitFlash", flash1);
-
             glm::vec3 baseColor = e.color;
 
             glm::vec3 finalColor = baseColor;
-            if (e.state == ENEMY_DYING) {
+            if (e.dying >= 0.0f) {
                 finalColor = glm::mix(glm::vec3(1.0f), baseColor, 0.5f);
             }
 
-            shader.setVec3("enemyColor", finalColor);
-            ufoModel.Draw(shader);
+            if (gpuDriven) {
+                gpuScene.Add(gpuUfo, enemyModel, finalColor, e.flash); // culled and LOD-picked on the GPU
+                continue;
+            }
+            BoundingSphere bounds = transformSphere(ufoLods.Bounds, enemyModel);
+            if (!frustum.Intersects(bounds))
+                continue;
+            int level = LodModel::SelectLevel(projectedDiameter(bounds, snap.cameraPosition, glm::radians(snap.fovDegrees), sceneHeight));
+            ufoInstances[level]->Add(enemyModel, finalColor, e.flash);
         }
 
-        // Draw skybox after everything else has been rendered
-        glDepthMask(GL_FALSE);           // Disable depth writing
-        glDepthFunc(GL_LEQUAL);          // Ensure the skybox is always behind other objects
-
-        skyboxShader.use();
-        glm::mat4 skyView = glm::mat4(glm::mat3(camera.GetViewMatrix()));  // Use the camera's view matrix without translation
-        skyboxShader.setMat4("view", skyView);
-        skyboxShader.setMat4("projection", projection);  // Ensure the skybox has the correct perspective projection
-
-        glBindVertexArray(skyboxVAO);
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_CUBE_MAP, cubemapTexture);
-        glDrawArrays(GL_TRIANGLES, 0, 36);  // Draw the skybox
-        glBindVertexArray(0);
+        playerInstances.Upload();
+        playerInstances.Submit(renderQueue, shader, true, containerTexture, glm::length(snap.playerPosition - snap.cameraPosition));
+        bulletInstances.Upload();
+        bulletInstances.Submit(renderQueue, tintShader, false, containerTexture);
+        size_t enemiesDrawn = 0, enemyTriangles = 0;
+        for (int level = 0; level < LodModel::kLevels; level++) {
+            ufoInstances[level]->Upload();
+            ufoInstances[level]->Submit(renderQueue, shader, true, containerTexture);
+            enemiesDrawn += ufoInstances[level]->Count();
+            enemyTriangles += ufoInstances[level]->Count() * ufoLods.Triangles(level);
+        }
+        if (gpuDriven) {
+            glActiveTexture(GL_TEXTURE0);
+            glBindTexture(GL_TEXTURE_2D, containerTexture); // for meshes without a diffuse texture, as Mesh::Draw leaves it
+            gpuScene.Draw(projection * view, snap.cameraPosition, glm::radians(snap.fovDegrees), sceneHeight);
+        }
 
-        glDepthFunc(GL_LESS);  // Restore the depth function
-        glDepthMask(GL_TRUE);  // Enable depth writing again
+        // Skybox in its own pass after everything opaque (depth LEQUAL, no depth write);
+        // view/projection come from the PerFrame block, the shader drops the translation itself
+        RenderItem sky;
+        sky.shader = &skyboxShader;
+        sky.textureTarget = GL_TEXTURE_CUBE_MAP;
+        sky.texture = cubemapTexture;
+        sky.vao = skyboxVAO;
+        sky.count = 36;
+        sky.indexed = false;
+        renderQueue.Submit(PASS_SKY, sky);
+        renderQueue.Flush();
+        profiler.EndZone();
 
 
         // now end scene pass
         glBindFramebuffer(GL_FRAMEBUFFER, 0);
 
+        // 2. blur bright fragments with the downsample/upsample mip chain (skipped when bloom is off)
+        // ------------------------------------------------------------------------------------------
+        bool bloomEnabled = snap.programChoice == 2 || snap.programChoice == 3;
+        profiler.BeginZone("bloom", true);
+        if (bloomEnabled)
+            renderTargets.Bloom().RenderBloomTexture(renderTargets.SceneTexture(), bloomFilterRadius);
+        profiler.EndZone();
+        glViewport(0, 0, snap.framebufferWidth, snap.framebufferHeight);
+
         // 3. now render floating point color buffer to 2D quad and tonemap HDR colors to default framebuffer's (clamped) color range
         // --------------------------------------------------------------------------------------------------------------------------
+        profiler.BeginZone("tonemap", true);
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        // the bloom mode is picked here rather than per pixel; anything else falls back to no bloom
+        const int bloomMode = (snap.programChoice >= 1 && snap.programChoice <= kBloomModes) ? snap.programChoice : 1;
+        CachedShader& shaderBloomFinal = *bloomFinalShaders[bloomMode - 1];
         shaderBloomFinal.use();
         glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, colorBuffers[0]);
+        glBindTexture(GL_TEXTURE_2D, renderTargets.SceneTexture());
         glActiveTexture(GL_TEXTURE1);
-        glBindTexture(GL_TEXTURE_2D, 0); // trick to bind invalid texture "0", we don't care either way!
+        glBindTexture(GL_TEXTURE_2D, bloomEnabled ? renderTargets.Bloom().BloomTexture() : 0);
 
 
-        shaderBloomFinal.setInt("programChoice", programChoice);
-        shaderBloomFinal.setFloat("exposure", exposure);
+        shaderBloomFinal.setFloat("exposure", snap.exposure);
         renderQuad();
+        profiler.EndZone();
 
+        profiler.BeginZone("hud", true);
         glDisable(GL_DEPTH_TEST);
         glEnable(GL_BLEND);
         glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
         // ----- HP BAR: black border + colored fill -----
-        float hpPercent = playerHealth / playerMaxHealth;
+        float hpPercent = snap.health;
         glm::vec3 hpColor = glm::mix(glm::vec3(1.0f, 0.0f, 0.0f),   // red when low
             glm::vec3(0.0f, 1.0f, 0.0f),   // green when full
             hpPercent);
@@ -1182,19 +1057,19 @@ int main()
 
         // ----- HP LABEL: top-left (draw ON TOP of bar) -----
         std::string hpLabel = "HP:";
-        RenderText(textShader, hpLabel,
+        hudText.Add(hpLabel,
             25.0f, SCR_HEIGHT - 40.0f,   // slightly lower
             0.6f, glm::vec3(1.0f, 1.0f, 1.0f)); // white
 
         // ----- SCORE TEXT: top-right -----
-        std::string scoreText = "Score: " + std::to_string(playerScore);
+        std::string scoreText = "Score: " + std::to_string(snap.score);
         float scoreX = SCR_WIDTH - 200.0f;
-        RenderText(textShader, scoreText,
+        hudText.Add(scoreText,
             scoreX, SCR_HEIGHT - 40.0f,
             0.6f, glm::vec3(1.0f, 1.0f, 0.0f)); // yellow
 
         // ----- START / PAUSE overlay text -----
-        if (gameState == GAME_START) {
+        if (snap.gameState == GAME_START) {
             std::string nameText = "KODJENG SPACESHIP";
             std::string startText = "Press ENTER to START";
             std::string controls1 = "Move: WASD | Aim: with a mouse | Pause: P";
@@ -1202,50 +1077,77 @@ int main()
             float cx = SCR_WIDTH * 0.5f - 220.0f;
             float cy = SCR_HEIGHT * 0.5f + 20.0f;
 
-            RenderText(textShader, nameText,
+            hudText.Add(nameText,
                 cx - 10.0, cy + 40.0 ,
                 1.0f, glm::vec3(2.0f, 2.0f, .0f));
 
-            RenderText(textShader, startText,
+            hudText.Add(startText,
                 cx, cy-20.0,
                 0.8f, glm::vec3(1.0f, 1.0f, 1.0f));
 
-            RenderText(textShader, controls1,
+            hudText.Add(controls1,
                 cx - 140.00 , cy - 60.0f,
                 0.6f, glm::vec3(0.8f, 0.8f, 0.8f));
         }
-        else if (gameState == GAME_PAUSED) {
+        else if (snap.gameState == GAME_PAUSED) {
             std::string pausedText = "PAUSED";
             std::string resumeText = "Press P to RESUME";
 
             float cx = SCR_WIDTH * 0.5f - 120.0f;
             float cy = SCR_HEIGHT * 0.5f + 20.0f;
 
-            RenderText(textShader, pausedText,
+            hudText.Add(pausedText,
                 cx + 40.0 , cy,
                 0.9f, glm::vec3(1.0f, 1.0f, 0.0f));
 
-            RenderText(textShader, resumeText,
+            hudText.Add(resumeText,
                 cx - 40.0f, cy - 40.0f,
                 0.7f, glm::vec3(1.0f, 1.0f, 1.0f));
         }
-        else if (gameState == GAME_OVER) {
+        else if (snap.gameState == GAME_OVER) {
             std::string overText = "GAME OVER";
             std::string restartText = "Press R to RESTART";
 
             float cx = SCR_WIDTH * 0.5f - 150.0f;
             float cy = SCR_HEIGHT * 0.5f + 20.0f;
 
-            RenderText(textShader, overText,
+            hudText.Add(overText,
                 cx + 10.0, cy,
                 1.0f, glm::vec3(1.0f, 0.0f, 0.0f)); // red
 
-            RenderText(textShader, restartText,
+            hudText.Add(restartText,
                 cx - 40.0f, cy - 50.0f,
                 0.7f, glm::vec3(1.0f, 1.0f, 1.0f)); // white
         }
 
+        // ----- Profiler overlay: avg / p99 ms per zone -----
+        if (snap.showProfiler) {
+            float y = SCR_HEIGHT - 80.0f;
+            for (const std::string& line : profiler.OverlayLines()) {
+                hudText.Add(line, 25.0f, y, 0.3f, glm::vec3(0.6f, 1.0f, 0.6f));
+                y -= 16.0f;
+            }
+            char culling[128];
+            if (gpuDriven)
+                std::snprintf(culling, sizeof(culling), "gpu-driven: %zu entities, %zu indirect draws",
+                    gpuScene.Count(), gpuScene.DrawCalls());
+            else
+                std::snprintf(culling, sizeof(culling), "enemies %zu/%zu drawn  lod %zu/%zu/%zu  %zuk tris",
+                    enemiesDrawn, snap.enemies.size(), ufoInstances[0]->Count(), ufoInstances[1]->Count(),
+                    ufoInstances[2]->Count(), enemyTriangles / 1000);
+            hudText.Add(culling, 25.0f, y, 0.3f, glm::vec3(0.6f, 1.0f, 0.6f));
+            y -= 16.0f;
+            char binds[96];
+            std::snprintf(binds, sizeof(binds), "scene state binds %d issued, %d saved",
+                glState.Issued(), glState.Saved());
+            hudText.Add(binds, 25.0f, y, 0.3f, glm::vec3(0.6f, 1.0f, 0.6f));
+            y -= 16.0f;
+            if (profiler.Capturing())
+                hudText.Add("capturing trace (F2 to stop)", 25.0f, y, 0.3f, glm::vec3(1.0f, 0.4f, 0.4f));
+        }
 
+        // all HUD / overlay text in one draw call
+        hudText.Draw(textShader);
 
         // ----- Crosshair in center -----
         crosshairShader.use();
@@ -1254,15 +1156,137 @@ int main()
 
         glDisable(GL_BLEND);
         glEnable(GL_DEPTH_TEST);
+        profiler.EndZone();
+        profiler.EndFrame();
+        glfwSwapBuffers(window);
+    };
 
+    auto publishSnapshot = [&]() {
+        RenderSnapshot& snap = renderSnapshots.Back();
+        captureWorld(world, simAlpha, snap);
 
+        // Make camera follow player (stick behind)
+        camera.Position = snap.playerPosition + glm::vec3(0.0f, 0.75f, 1.0f);
+        snap.view = camera.GetViewMatrix();
+        snap.cameraPosition = camera.Position;
+        snap.fovDegrees = camera.Zoom;
+
+        snap.gameState = gameState;
+        snap.programChoice = programChoice;
+        snap.exposure = exposure;
+        snap.renderScale = renderScale;
+        snap.framebufferWidth = framebufferWidth;
+        snap.framebufferHeight = framebufferHeight;
+        snap.showProfiler = showProfiler;
+        renderSnapshots.Publish();
+    };
 
+    std::atomic<bool> rendering(true);
+    std::atomic<bool> snapshotWanted(true); // render thread took the last snapshot
+    std::thread renderThread;
+    if (renderThreaded) {
+        glfwMakeContextCurrent(NULL);
+        renderThread = std::thread([&]() {
+            glfwMakeContextCurrent(window);
+            while (rendering.load()) {
+                // nothing new since the last frame: wait for the next publish instead of redrawing it
+                if (!renderSnapshots.Acquire()) {
+                    std::this_thread::sleep_for(std::chrono::microseconds(200));
+                    continue;
+                }
+                renderFrame(renderSnapshots.Front());
+                snapshotWanted.store(true);
+            }
+            glfwMakeContextCurrent(NULL);
+        });
+    }
 
-        glfwSwapBuffers(window);
-        glfwPollEvents();
+    while (!glfwWindowShouldClose(window))
+    {
+        // per-frame time logic
+        float currentFrame = static_cast<float>(glfwGetTime());
+        deltaTime = currentFrame - lastFrame;
+        lastFrame = currentFrame;
+
+        // input
+        profiler.BeginZone("input", false);
+        processInput(window);
+        profiler.EndZone();
+
+        // ---------- GAME LOGIC: only run when playing ----------
+        profiler.BeginZone("sim", false);
+        if (gameState == GAME_PLAYING) {
+            const float simStep = 1.0f / simHz;
+            playerInput.aim = camera.Front;
+            simAccumulator += deltaTime;
+
+            int steps = 0;
+            while (simAccumulator >= simStep && steps < kMaxSimStepsPerFrame && gameState == GAME_PLAYING) {
+                inputRecorder.Step(simStep, playerInput);
+                StepEvents events = world.Step(simStep, playerInput);
+                simAccumulator -= simStep;
+                steps++;
+
+                gSfx.Queue(sfxHit, events.enemiesHit);
+                gSfx.Queue(sfxDamage, events.playerHits);
+
+                // ---- Check for game over ----
+                if (world.IsPlayerDead()) {
+                    gameState = GAME_OVER;
+                }
+            }
+            if (simAccumulator >= simStep)
+                simAccumulator = std::fmod(simAccumulator, simStep);
+            simAlpha = simAccumulator / simStep;
+        }
+        else {
+            // paused / menus: keep showing the same blend, don't bank time
+            simAccumulator = 0.0f;
+        }
+        // hits from this iteration's ticks start together, one voice per sound
+        gSfx.Flush();
+        audio->Update(deltaTime);
+        profiler.EndZone();
+
+        // the input loop runs at ~1 kHz, so only copy a snapshot once the
+        // render thread has taken the previous one
+        if (!renderThreaded || snapshotWanted.exchange(false)) {
+            profiler.BeginZone("publish", false);
+            publishSnapshot();
+            profiler.EndZone();
+        }
+
+        if (renderThreaded) {
+            // wake up on input, otherwise poll about once a millisecond
+            glfwWaitEventsTimeout(0.001);
+        }
+        else {
+            renderSnapshots.Acquire();
+            renderFrame(renderSnapshots.Front());
+            glfwPollEvents();
+        }
     }
 
-    bloomRenderer.Destroy();
+    if (renderThreaded) {
+        rendering.store(false);
+        renderThread.join();
+        glfwMakeContextCurrent(window);
+    }
+
+    for (auto& lod : ufoInstances)
+        lod->Destroy();
+    bulletInstances.Destroy();
+    playerInstances.Destroy();
+    renderTargets.Destroy();
+    gpuScene.Destroy();
+    perFrameBuffer.Destroy();
+    hudText.Destroy();
+    if (profiler.Capturing())
+        profiler.StopCapture(kTracePath);
+    profiler.Destroy();
+    inputRecorder.Close();
+    gSfx.Destroy();
+    audio.reset();
     glfwTerminate();
     return 0;
 }
@@ -1314,34 +1338,66 @@ void processInput(GLFWwindow* window)
         camera.ProcessKeyboard(RIGHT, deltaTime);
 
 
-    // Player movement (left/right)
+    // Player movement (left/right), applied by the simulation in World::Step
+    playerInput.move = glm::vec2(0.0f);
     if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS)
-        playerPosition.x -= playerSpeed * deltaTime;
+        playerInput.move.x -= 1.0f;
     if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS)
-        playerPosition.x += playerSpeed * deltaTime;
+        playerInput.move.x += 1.0f;
 
     // Add vertical movement (up/down)
     if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS)
-        playerPosition.y += playerSpeed * deltaTime; // Move up
+        playerInput.move.y += 1.0f; // Move up
     if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS)
-        playerPosition.y -= playerSpeed * deltaTime; // Move down
+        playerInput.move.y -= 1.0f; // Move down
 
-    // Clamp player within screen limits for X and Y
-    playerPosition.x = glm::clamp(playerPosition.x, -4.0f, 4.0f); // horizontal limits
-    playerPosition.y = glm::clamp(playerPosition.y, -5.0f, 1.0f); // vertical limits (adjust as needed)
 
+    // bloom mode
+    if (glfwGetKey(window, GLFW_KEY_1) == GLFW_PRESS)
+        programChoice = 1;
+    if (glfwGetKey(window, GLFW_KEY_2) == GLFW_PRESS)
+        programChoice = 2;
+    if (glfwGetKey(window, GLFW_KEY_3) == GLFW_PRESS)
+        programChoice = 3;
 
     if (glfwGetKey(window, GLFW_KEY_Q) == GLFW_PRESS)
     {
-        if (exposure > 0.0f)
-            exposure -= 0.001f;
-        else
-            exposure = 0.0f;
+        exposure = std::max(exposure - kExposureSpeed * deltaTime, 0.0f);
     }
     else if (glfwGetKey(window, GLFW_KEY_E) == GLFW_PRESS)
     {
-        exposure += 0.001f;
+        exposure += kExposureSpeed * deltaTime;
+    }
+
+    // render scale (edge-triggered)
+    static bool scaleDownLast = false;
+    int scaleDownState = glfwGetKey(window, GLFW_KEY_LEFT_BRACKET);
+    if (scaleDownState == GLFW_PRESS && !scaleDownLast)
+        renderScale = glm::clamp(renderScale - kRenderScaleStep, kMinRenderScale, kMaxRenderScale);
+    scaleDownLast = (scaleDownState == GLFW_PRESS);
+
+    static bool scaleUpLast = false;
+    int scaleUpState = glfwGetKey(window, GLFW_KEY_RIGHT_BRACKET);
+    if (scaleUpState == GLFW_PRESS && !scaleUpLast)
+        renderScale = glm::clamp(renderScale + kRenderScaleStep, kMinRenderScale, kMaxRenderScale);
+    scaleUpLast = (scaleUpState == GLFW_PRESS);
+
+    // profiler overlay / trace capture (edge-triggered)
+    static bool f1Last = false;
+    int f1State = glfwGetKey(window, GLFW_KEY_F1);
+    if (f1State == GLFW_PRESS && !f1Last)
+        showProfiler = !showProfiler;
+    f1Last = (f1State == GLFW_PRESS);
+
+    static bool f2Last = false;
+    int f2State = glfwGetKey(window, GLFW_KEY_F2);
+    if (f2State == GLFW_PRESS && !f2Last) {
+        if (profiler.Capturing())
+            profiler.StopCapture(kTracePath);
+        else
+            profiler.StartCapture();
     }
+    f2Last = (f2State == GLFW_PRESS);
 
     // ---------- Start / Pause controls (edge-triggered) ----------
     static bool enterLast = false;
@@ -1422,9 +1478,11 @@ void renderQuad_cross()
 // ---------------------------------------------------------------------------------------------
 void framebuffer_size_callback(GLFWwindow* window, int width, int height)
 {
-    // make sure the viewport matches the new window dimensions; note that width and
-    // height will be significantly larger than specified on retina displays.
-    glViewport(0, 0, width, height);
+    // note that width and height will be significantly larger than specified on retina displays.
+    // Runs on the main thread, which doesn't hold the GL context: the new size reaches the
+    // renderer through the next snapshot, and the render targets and viewport follow it.
+    framebufferWidth = width;
+    framebufferHeight = height;
 }
 
 // glfw: whenever the mouse moves, this callback is called
@@ -1479,52 +1537,6 @@ void scroll_callback(GLFWwindow* window, double xoffset, double yoffset)
 
 // utility function for loading a 2D texture from file
 // ---------------------------------------------------
-unsigned int loadTexture(char const* path, bool gammaCorrection)
-{
-    unsigned int textureID;
-    glGenTextures(1, &textureID);
-
-    int width, height, nrComponents;
-    unsigned char* data = stbi_load(path, &width, &height, &nrComponents, 0);
-    if (data)
-    {
-        GLenum internalFormat;
-        GLenum dataFormat;
-        if (nrComponents == 1)
-        {
-            internalFormat = dataFormat = GL_RED;
-        }
-        else if (nrComponents == 3)
-        {
-            internalFormat = gammaCorrection ? GL_SRGB : GL_RGB;
-            dataFormat = GL_RGB;
-        }
-        else if (nrComponents == 4)
-        {
-            internalFormat = gammaCorrection ? GL_SRGB_ALPHA : GL_RGBA;
-            dataFormat = GL_RGBA;
-        }
-
-        glBindTexture(GL_TEXTURE_2D, textureID);
-        glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, width, height, 0, dataFormat, GL_UNSIGNED_BYTE, data);
-        glGenerateMipmap(GL_TEXTURE_2D);
-
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-        stbi_image_free(data);
-    }
-    else
-    {
-        std::cout << "Texture failed to load at path: " << path << std::endl;
-        stbi_image_free(data);
-    }
-
-    return textureID;
-}
-
 void renderHealthBar(float healthPercent, bool inner)
 {
     // Clamp 01
@@ -1590,43 +1602,3 @@ void renderHealthBar(float healthPercent, bool inner)
     glDrawArrays(GL_TRIANGLES, 0, 6);
     glBindVertexArray(0);
 }
-
-void RenderText(Shader& s, const std::string& text,
-    float x, float y, float scale, glm::vec3 color)
-{
-    s.use();
-    s.setVec3("textColor", color);
-    glActiveTexture(GL_TEXTURE0);
-    glBindVertexArray(textVAO);
-
-    for (char c : text) {
-        Character ch = Characters[c];
-
-        float xpos = x + ch.Bearing.x * scale;
-        float ypos = y - (ch.Size.y - ch.Bearing.y) * scale;
-
-        float w = ch.Size.x * scale;
-        float h = ch.Size.y * scale;
-
-        float vertices[6][4] = {
-            { xpos,     ypos + h,   0.0f, 0.0f },
-            { xpos,     ypos,       0.0f, 1.0f },
-            { xpos + w, ypos,       1.0f, 1.0f },
-
-            { xpos,     ypos + h,   0.0f, 0.0f },
-            { xpos + w, ypos,       1.0f, 1.0f },
-            { xpos + w, ypos + h,   1.0f, 0.0f }
-        };
-
-        glBindTexture(GL_TEXTURE_2D, ch.TextureID);
-
-        glBindBuffer(GL_ARRAY_BUFFER, textVBO);
-        glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(vertices), vertices);
-
-        glDrawArrays(GL_TRIANGLES, 0, 6);
-        x += (ch.Advance >> 6) * scale;
-    }
-
-    glBindVertexArray(0);
-    glBindTexture(GL_TEXTURE_2D, 0);
-}
@@ -0,0 +1,320 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <glad/glad.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Per-frame CPU / GPU zone timing.
+//
+// CPU zones are steady_clock spans. GPU zones additionally wrap the GL commands
+// in a GL_TIME_ELAPSED query; queries live in a small ring per zone and are only
+// read back once their result is available, a few frames later, so the CPU
+// never waits on the GPU. GL_TIME_ELAPSED queries cannot nest, so GPU zones
+// must be sequential.
+//
+// Every zone keeps the last kHistory samples for rolling average and p99, and
+// while a capture is running every span is also recorded for a Chrome trace
+// (chrome://tracing or ui.perfetto.dev). GPU spans in the trace start at the
+// zone's CPU begin time; only their duration is measured on the GPU.
+//
+// CPU zones may be opened from several threads (one open zone per thread at a
+// time); each thread gets its own track in the trace. GPU zones, BeginFrame /
+// EndFrame and Destroy belong to the thread that owns the GL context.
+class FrameProfiler
+{
+public:
+    static const int kQueryRing = 4;
+    static const int kHistory = 240;
+
+    struct Stats {
+        float avgMs = 0.0f;
+        float p99Ms = 0.0f;
+    };
+
+    FrameProfiler() : mEpoch(Clock::now()), mFrame(0), mCapturing(false) {}
+
+    // call while the GL context is still alive
+    void Destroy()
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        for (Zone& z : mZones) {
+            if (z.gpu) glDeleteQueries(kQueryRing, z.queries);
+            z.gpu = false;
+        }
+    }
+
+    void BeginFrame()
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        collectGpuResults();
+    }
+
+    void EndFrame()
+    {
+        mFrame++;
+    }
+
+    // start a zone; gpu = also time the GL commands issued until EndZone()
+    void BeginZone(const char* name, bool gpu)
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        Zone& z = mZones[zoneIndex(name, gpu)];
+        z.open = true;
+        z.owner = std::this_thread::get_id();
+        z.cpuBegin = Clock::now();
+        if (z.gpu) {
+            int slot = mFrame % kQueryRing;
+            glBeginQuery(GL_TIME_ELAPSED, z.queries[slot]);
+            z.pending[slot] = true;
+            z.pendingBeginUs[slot] = microseconds(z.cpuBegin);
+        }
+    }
+
+    void EndZone()
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        int id = openZone(std::this_thread::get_id());
+        if (id < 0) return;
+        Zone& z = mZones[id];
+        z.open = false;
+        if (z.gpu) glEndQuery(GL_TIME_ELAPSED);
+
+        Clock::time_point end = Clock::now();
+        float ms = std::chrono::duration<float, std::milli>(end - z.cpuBegin).count();
+        push(z.cpu, ms);
+        if (mCapturing)
+            mTrace.push_back({ z.name, microseconds(z.cpuBegin), microseconds(end) - microseconds(z.cpuBegin), threadTrack(z.owner) });
+    }
+
+    Stats CpuStats(const char* name) const
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        int id = findZone(name);
+        return id < 0 ? Stats() : stats(mZones[id].cpu);
+    }
+
+    Stats GpuStats(const char* name) const
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        int id = findZone(name);
+        return id < 0 ? Stats() : stats(mZones[id].gpuSamples);
+    }
+
+    // one line per zone, e.g. "scene   cpu 0.21/0.40  gpu 1.10/1.32" (avg/p99 ms)
+    std::vector<std::string> OverlayLines() const
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        std::vector<std::string> lines;
+        char buf[128];
+        for (const Zone& z : mZones) {
+            Stats c = stats(z.cpu);
+            if (z.gpu) {
+                Stats g = stats(z.gpuSamples);
+                std::snprintf(buf, sizeof(buf), "%-8s cpu %5.2f/%5.2f  gpu %5.2f/%5.2f", z.name, c.avgMs, c.p99Ms, g.avgMs, g.p99Ms);
+            }
+            else {
+                std::snprintf(buf, sizeof(buf), "%-8s cpu %5.2f/%5.2f", z.name, c.avgMs, c.p99Ms);
+            }
+            lines.push_back(buf);
+        }
+        return lines;
+    }
+
+    bool Capturing() const
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        return mCapturing;
+    }
+
+    void StartCapture()
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mTrace.clear();
+        mCapturing = true;
+    }
+
+    // stop recording and write everything captured as Chrome trace event JSON
+    bool StopCapture(const std::string& path)
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mCapturing = false;
+        std::ofstream out(path);
+        if (!out) {
+            std::printf("Failed to write profile trace to %s\n", path.c_str());
+            return false;
+        }
+        out << "{\"traceEvents\":[\n";
+        out << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << kGpuTrack << ",\"args\":{\"name\":\"GPU\"}}";
+        for (int i = 0; i < (int)mThreads.size(); i++) {
+            out << ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << kFirstCpuTrack + i
+                << ",\"args\":{\"name\":\"CPU " << i << "\"}}";
+        }
+        for (const TraceEvent& e : mTrace) {
+            out << ",\n{\"name\":\"" << e.name << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << e.track
+                << ",\"ts\":" << e.beginUs << ",\"dur\":" << e.durUs << "}";
+        }
+        out << "\n]}\n";
+        std::printf("Wrote %d trace events to %s\n", (int)mTrace.size(), path.c_str());
+        return true;
+    }
+
+private:
+    typedef std::chrono::steady_clock Clock;
+    static const int kGpuTrack = 1;
+    static const int kFirstCpuTrack = 2; // one per thread, in order of first use
+
+    struct History {
+        float samples[kHistory];
+        int count = 0;
+        int next = 0;
+    };
+
+    struct Zone {
+        const char* name;
+        bool gpu = false;
+        bool open = false;
+        std::thread::id owner;
+        Clock::time_point cpuBegin;
+        History cpu;
+        History gpuSamples;
+        GLuint queries[kQueryRing];
+        bool pending[kQueryRing];
+        long long pendingBeginUs[kQueryRing];
+    };
+
+    struct TraceEvent {
+        const char* name;
+        long long beginUs;
+        long long durUs;
+        int track;
+    };
+
+    Clock::time_point mEpoch;
+    int mFrame;
+    bool mCapturing;
+    std::vector<Zone> mZones;
+    std::vector<TraceEvent> mTrace;
+    std::vector<std::thread::id> mThreads;
+    mutable std::mutex mMutex;
+
+    long long microseconds(Clock::time_point t) const
+    {
+        return std::chrono::duration_cast<std::chrono::microseconds>(t - mEpoch).count();
+    }
+
+    int findZone(const char* name) const
+    {
+        for (int i = 0; i < (int)mZones.size(); i++)
+            if (mZones[i].name == name || std::strcmp(mZones[i].name, name) == 0)
+                return i;
+        return -1;
+    }
+
+    int openZone(std::thread::id thread) const
+    {
+        for (int i = 0; i < (int)mZones.size(); i++)
+            if (mZones[i].open && mZones[i].owner == thread)
+                return i;
+        return -1;
+    }
+
+    int threadTrack(std::thread::id thread)
+    {
+        for (int i = 0; i < (int)mThreads.size(); i++)
+            if (mThreads[i] == thread)
+                return kFirstCpuTrack + i;
+        mThreads.push_back(thread);
+        return kFirstCpuTrack + (int)mThreads.size() - 1;
+    }
+
+    // zones are created on first use; name must outlive the profiler (string literals)
+    int zoneIndex(const char* name, bool gpu)
+    {
+        int id = findZone(name);
+        if (id >= 0) return id;
+
+        Zone z;
+        z.name = name;
+        z.gpu = gpu;
+        if (gpu) {
+            glGenQueries(kQueryRing, z.queries);
+            for (int i = 0; i < kQueryRing; i++) z.pending[i] = false;
+        }
+        mZones.push_back(z);
+        return (int)mZones.size() - 1;
+    }
+
+    // read back every finished query without blocking
+    void collectGpuResults()
+    {
+        for (Zone& z : mZones) {
+            if (!z.gpu) continue;
+            for (int slot = 0; slot < kQueryRing; slot++) {
+                if (!z.pending[slot]) continue;
+                GLint available = 0;
+                glGetQueryObjectiv(z.queries[slot], GL_QUERY_RESULT_AVAILABLE, &available);
+                if (!available) continue;
+
+                GLuint64 ns = 0;
+                glGetQueryObjectui64v(z.queries[slot], GL_QUERY_RESULT, &ns);
+                z.pending[slot] = false;
+                push(z.gpuSamples, ns / 1.0e6f);
+                if (mCapturing)
+                    mTrace.push_back({ z.name, z.pendingBeginUs[slot], (long long)(ns / 1000), kGpuTrack });
+            }
+        }
+    }
+
+    static void push(History& h, float ms)
+    {
+        h.samples[h.next] = ms;
+        h.next = (h.next + 1) % kHistory;
+        if (h.count < kHistory) h.count++;
+    }
+
+    static Stats stats(const History& h)
+    {
+        Stats s;
+        if (h.count == 0) return s;
+
+        float sorted[kHistory];
+        float sum = 0.0f;
+        for (int i = 0; i < h.count; i++) {
+            sorted[i] = h.samples[i];
+            sum += h.samples[i];
+        }
+        s.avgMs = sum / h.count;
+        int p99 = std::min(h.count - 1, (int)(h.count * 0.99f));
+        std::nth_element(sorted, sorted + p99, sorted + h.count);
+        s.p99Ms = sorted[p99];
+        return s;
+    }
+};
+
+// RAII helper: profiles the enclosing scope
+class ProfileZone
+{
+public:
+    ProfileZone(FrameProfiler& profiler, const char* name, bool gpu = false) : mProfiler(profiler)
+    {
+        mProfiler.BeginZone(name, gpu);
+    }
+    ~ProfileZone()
+    {
+        mProfiler.EndZone();
+    }
+
+private:
+    FrameProfiler& mProfiler;
+};
+
+#endif
@@ -0,0 +1,160 @@
+#ifndef PROGRAM_CACHE_H
+#define PROGRAM_CACHE_H
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+#include "mapped_file.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#ifndef GL_PROGRAM_BINARY_RETRIEVABLE_HINT
+#define GL_PROGRAM_BINARY_RETRIEVABLE_HINT 0x8257
+#endif
+#ifndef GL_PROGRAM_BINARY_LENGTH
+#define GL_PROGRAM_BINARY_LENGTH 0x8741
+#endif
+#ifndef GL_NUM_PROGRAM_BINARY_FORMATS
+#define GL_NUM_PROGRAM_BINARY_FORMATS 0x87FE
+#endif
+
+// Linked programs saved with glGetProgramBinary and restored with
+// glProgramBinary (GL 4.1 / ARB_get_program_binary), so later launches skip
+// compiling and linking. A cache file records a hash of the shader sources
+// and of the driver (vendor, renderer and version strings). A missing file, a
+// different hash or a binary the driver refuses makes Load() return 0: the
+// caller compiles from source and Save()s the result over the old file.
+//
+// Needs a current context; without the entry points or any binary format
+// Load() and Save() do nothing.
+class ProgramBinaryCache
+{
+public:
+    static bool Enabled()
+    {
+        if (sState < 0) {
+            GLint formats = 0;
+            loadEntryPoints();
+            if (sGetProgramBinary && sProgramBinary && sProgramParameteri)
+                glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+            sState = formats > 0 ? 1 : 0;
+        }
+        return sState == 1;
+    }
+
+    // call between creating and linking a program that will be Save()d
+    static void PrepareLink(unsigned int program)
+    {
+        if (Enabled())
+            sProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    }
+
+    // a linked program restored from path, or 0 on any mismatch
+    static unsigned int Load(const std::string& path, uint64_t sourceHash)
+    {
+        if (!Enabled()) return 0;
+
+        MappedFile file;
+        if (!file.Open(path) || file.Size() < sizeof(FileHeader)) {
+            sMisses++;
+            return 0;
+        }
+        FileHeader header;
+        std::memcpy(&header, file.Data(), sizeof(header));
+        if (header.magic != kMagic || header.version != kVersion || header.sourceHash != sourceHash ||
+            header.driverHash != driverHash() || header.size != file.Size() - sizeof(header)) {
+            sMisses++;
+            return 0;
+        }
+
+        unsigned int program = glCreateProgram();
+        sProgramBinary(program, header.format, file.Data() + sizeof(header), (GLsizei)header.size);
+        GLint ok = 0;
+        glGetProgramiv(program, GL_LINK_STATUS, &ok);
+        if (!ok) {
+            // driver rejected it (e.g. an update that kept the version string)
+            glDeleteProgram(program);
+            sMisses++;
+            return 0;
+        }
+        sHits++;
+        return program;
+    }
+
+    static void Save(const std::string& path, uint64_t sourceHash, unsigned int program)
+    {
+        if (!Enabled()) return;
+
+        GLint length = 0;
+        glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+        if (length <= 0) return;
+        std::vector<unsigned char> binary(length);
+        GLenum format = 0;
+        sGetProgramBinary(program, length, &length, &format, binary.data());
+
+        // temp file + rename, like the mesh and texture caches
+        const std::string tmpPath = path + ".tmp";
+        {
+            std::ofstream out(tmpPath, std::ios::binary | std::ios::trunc);
+            if (!out) return;
+            FileHeader header = { kMagic, kVersion, sourceHash, driverHash(), format, (uint32_t)length };
+            out.write((const char*)&header, sizeof(header));
+            out.write((const char*)binary.data(), length);
+            if (!out) return;
+        }
+        std::remove(path.c_str());
+        std::rename(tmpPath.c_str(), path.c_str());
+    }
+
+    // programs restored / compiled since startup
+    static int Hits() { return sHits; }
+    static int Misses() { return sMisses; }
+
+private:
+    static const uint32_t kMagic = 0x4E494250; // "PBIN"
+    static const uint32_t kVersion = 1;
+
+    struct FileHeader {
+        uint32_t magic;
+        uint32_t version;
+        uint64_t sourceHash;
+        uint64_t driverHash;
+        uint32_t format;
+        uint32_t size;
+    };
+
+    typedef void (APIENTRYP GetProgramBinaryProc)(GLuint, GLsizei, GLsizei*, GLenum*, void*);
+    typedef void (APIENTRYP ProgramBinaryProc)(GLuint, GLenum, const void*, GLsizei);
+    typedef void (APIENTRYP ProgramParameteriProc)(GLuint, GLenum, GLint);
+    static inline GetProgramBinaryProc sGetProgramBinary = nullptr;
+    static inline ProgramBinaryProc sProgramBinary = nullptr;
+    static inline ProgramParameteriProc sProgramParameteri = nullptr;
+    static inline int sState = -1; // -1 = not checked yet
+    static inline int sHits = 0;
+    static inline int sMisses = 0;
+
+    static void loadEntryPoints()
+    {
+        sGetProgramBinary = (GetProgramBinaryProc)glfwGetProcAddress("glGetProgramBinary");
+        sProgramBinary = (ProgramBinaryProc)glfwGetProcAddress("glProgramBinary");
+        sProgramParameteri = (ProgramParameteriProc)glfwGetProcAddress("glProgramParameteri");
+    }
+
+    static uint64_t driverHash()
+    {
+        std::string driver;
+        for (GLenum name : { GL_VENDOR, GL_RENDERER, GL_VERSION }) {
+            const GLubyte* s = glGetString(name);
+            driver += s ? (const char*)s : "";
+            driver += '\n';
+        }
+        return hashBytes((const unsigned char*)driver.data(), driver.size());
+    }
+};
+
+#endif
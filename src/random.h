@@ -0,0 +1,70 @@
+#ifndef RANDOM_H
+#define RANDOM_H
+
+#include <cstdint>
+
+// PCG32 (XSH-RR, 64-bit state) - small, fast and fully determined by its seed,
+// so a World seeded the same way always plays out the same way, unlike rand()
+// which is shared by everything in the process.
+class Pcg32
+{
+public:
+    static const uint64_t kDefaultSeed = 0x853c49e6748fea9bull;
+    static const uint64_t kDefaultStream = 0xda3e39cb94b95bdbull;
+
+    Pcg32(uint64_t seed = kDefaultSeed, uint64_t stream = kDefaultStream)
+    {
+        Seed(seed, stream);
+    }
+
+    void Seed(uint64_t seed, uint64_t stream = kDefaultStream)
+    {
+        mState = 0;
+        mInc = (stream << 1u) | 1u;
+        Next();
+        mState += seed;
+        Next();
+    }
+
+    uint32_t Next()
+    {
+        uint64_t old = mState;
+        mState = old * 6364136223846793005ull + mInc;
+        uint32_t xorshifted = (uint32_t)(((old >> 18u) ^ old) >> 27u);
+        uint32_t rot = (uint32_t)(old >> 59u);
+        return (xorshifted >> rot) | (xorshifted << ((32u - rot) & 31u));
+    }
+
+    // uniform in [0, 1)
+    float NextFloat()
+    {
+        return (Next() >> 8) * (1.0f / 16777216.0f);
+    }
+
+    // uniform in [min, max)
+    float Range(float min, float max)
+    {
+        return min + NextFloat() * (max - min);
+    }
+
+    // uniform in [0, bound), without modulo bias
+    uint32_t Below(uint32_t bound)
+    {
+        uint64_t m = (uint64_t)Next() * bound;
+        uint32_t low = (uint32_t)m;
+        if (low < bound) {
+            uint32_t threshold = (0u - bound) % bound;
+            while (low < threshold) {
+                m = (uint64_t)Next() * bound;
+                low = (uint32_t)m;
+            }
+        }
+        return (uint32_t)(m >> 32);
+    }
+
+private:
+    uint64_t mState;
+    uint64_t mInc;
+};
+
+#endif
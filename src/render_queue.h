@@ -0,0 +1,117 @@
+#ifndef RENDER_QUEUE_H
+#define RENDER_QUEUE_H
+
+#include <glad/glad.h>
+
+#include "cached_shader.h"
+#include "gl_state.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+// Passes drawn in this order; each sets its own depth / blend state.
+enum RenderPass {
+    PASS_OPAQUE = 0, // depth test + write
+    PASS_SKY = 1     // depth test LEQUAL, no write, after everything opaque
+};
+
+// One draw call and everything it binds. Material = the texture on unit 0;
+// variants like tint-only are separate programs (see cached_shader.h).
+struct RenderItem {
+    const CachedShader* shader = nullptr;
+    GLenum textureTarget = GL_TEXTURE_2D;
+    unsigned int texture = 0;  // 0 = leave unit 0 alone
+    unsigned int vao = 0;
+    GLsizei count = 0;         // indices, or vertices when !indexed
+    GLsizei instances = 0;     // 0 = not instanced
+    bool indexed = true;
+};
+
+// Draws are Submit()ted with a 64-bit sort key
+//   pass (4 bits) | program (12) | material (16) | mesh (16) | depth (16)
+// and Flush() sorts the keys and replays the items through a GLStateCache, so
+// items sharing a program, texture or vertex array bind it once. Depth is the
+// view distance, nearer first, which only orders draws that share everything
+// else.
+class RenderQueue
+{
+public:
+    static constexpr float kMaxDepth = 100.0f; // far plane
+
+    RenderQueue(GLStateCache& state) : mState(state) {}
+
+    void Submit(RenderPass pass, const RenderItem& item, float depth = 0.0f)
+    {
+        Entry e;
+        e.key = makeKey(pass, item, depth);
+        e.item = (uint32_t)mItems.size();
+        mItems.push_back(item);
+        mOrder.push_back(e);
+    }
+
+    size_t Size() const { return mItems.size(); }
+
+    // draw everything submitted since the last Flush() in key order, then
+    // leave the opaque pass state (depth write on, GL_LESS, no blend) behind
+    void Flush()
+    {
+        std::sort(mOrder.begin(), mOrder.end(), [](const Entry& a, const Entry& b) { return a.key < b.key; });
+
+        mState.Invalidate(); // anything may have touched GL since the last flush
+        int pass = -1;
+        for (const Entry& e : mOrder) {
+            const RenderItem& item = mItems[e.item];
+            int itemPass = (int)(e.key >> 60);
+            if (itemPass != pass) {
+                pass = itemPass;
+                applyPass(pass);
+            }
+            mState.UseProgram(item.shader->ID);
+            if (item.texture)
+                mState.BindTexture(0, item.textureTarget, item.texture);
+            mState.BindVertexArray(item.vao);
+
+            if (item.indexed && item.instances > 0)
+                glDrawElementsInstanced(GL_TRIANGLES, item.count, GL_UNSIGNED_INT, 0, item.instances);
+            else if (item.indexed)
+                glDrawElements(GL_TRIANGLES, item.count, GL_UNSIGNED_INT, 0);
+            else
+                glDrawArrays(GL_TRIANGLES, 0, item.count);
+        }
+        mState.BindVertexArray(0);
+        applyPass(PASS_OPAQUE);
+
+        mItems.clear();
+        mOrder.clear();
+    }
+
+private:
+    struct Entry {
+        uint64_t key;
+        uint32_t item;
+    };
+
+    GLStateCache& mState;
+    std::vector<RenderItem> mItems;
+    std::vector<Entry> mOrder;
+
+    static uint64_t makeKey(RenderPass pass, const RenderItem& item, float depth)
+    {
+        uint64_t program = item.shader->ID & 0xFFF;
+        uint64_t material = item.texture & 0xFFFF;
+        uint64_t mesh = item.vao & 0xFFFF;
+        uint64_t z = (uint64_t)(std::min(std::max(depth / kMaxDepth, 0.0f), 1.0f) * 65535.0f);
+        return ((uint64_t)pass << 60) | (program << 48) | (material << 32) | (mesh << 16) | z;
+    }
+
+    void applyPass(int pass)
+    {
+        mState.SetDepthTest(true);
+        mState.SetBlend(false);
+        mState.SetDepthMask(pass != PASS_SKY);
+        mState.SetDepthFunc(pass == PASS_SKY ? GL_LEQUAL : GL_LESS);
+    }
+};
+
+#endif
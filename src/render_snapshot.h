@@ -0,0 +1,84 @@
+#ifndef RENDER_SNAPSHOT_H
+#define RENDER_SNAPSHOT_H
+
+#include <glm/glm.hpp>
+
+#include "world.h"
+
+#include <vector>
+
+// Everything the render thread needs to draw one frame, copied out of the
+// simulation thread's state and handed over through a TripleBuffer, so the
+// renderer reads it without locks while the next ticks run. Positions are
+// already interpolated between the last two ticks.
+
+struct EnemyDraw {
+    glm::vec3 position;
+    glm::vec3 color;
+    float flash;  // emissive boost, kFlashBoost -> 0
+    float dying;  // death animation progress in [0, 1], or < 0 while alive
+};
+
+struct RenderSnapshot {
+    // camera
+    glm::mat4 view = glm::mat4(1.0f);
+    glm::vec3 cameraPosition = glm::vec3(0.0f);
+    float fovDegrees = 45.0f;
+
+    // world
+    glm::vec3 playerPosition = glm::vec3(0.0f);
+    float playerFlash = 0.0f;
+    std::vector<glm::vec3> playerBullets;
+    std::vector<glm::vec3> enemyBullets;
+    std::vector<EnemyDraw> enemies;
+
+    // HUD
+    float health = 1.0f; // fraction of playerMaxHealth
+    int score = 0;
+    int gameState = 0;
+
+    // display settings
+    int programChoice = 3;
+    float exposure = 1.0f;
+    float renderScale = 1.0f;
+    int framebufferWidth = 0;
+    int framebufferHeight = 0;
+    bool showProfiler = false;
+};
+
+// copy the drawable part of the world, blended alpha of the way from the
+// previous tick to the current one
+inline void captureWorld(const World& world, float alpha, RenderSnapshot& out)
+{
+    out.playerPosition = world.InterpolatedPlayer(alpha);
+    out.playerFlash = (world.PlayerFlashT > 0.0f)
+        ? (world.PlayerFlashT / kPlayerFlashDur) * kPlayerFlashBoost
+        : 0.0f;
+
+    out.playerBullets.clear();
+    for (int i = 0; i < world.Bullets.Size(); ++i)
+        out.playerBullets.push_back(world.Bullets.Interpolated(i, alpha));
+
+    out.enemyBullets.clear();
+    for (int i = 0; i < world.EnemyBullets.Size(); ++i)
+        out.enemyBullets.push_back(world.EnemyBullets.Interpolated(i, alpha));
+
+    out.enemies.clear();
+    const EnemyPool& enemies = world.Enemies;
+    for (int i = 0; i < enemies.Size(); ++i) {
+        // skip only if fully dead; dying enemies still play their animation
+        if (!enemies.Alive(i)) continue;
+
+        EnemyDraw d;
+        d.position = enemies.Interpolated(i, alpha);
+        d.color = enemies.Color[i];
+        d.flash = (enemies.FlashT[i] > 0.0f) ? (enemies.FlashT[i] / kFlashDur) * kFlashBoost : 0.0f;
+        d.dying = (enemies.State[i] == ENEMY_DYING) ? glm::clamp(enemies.DeathT[i] / kDeathDur, 0.0f, 1.0f) : -1.0f;
+        out.enemies.push_back(d);
+    }
+
+    out.health = world.PlayerHealth / playerMaxHealth;
+    out.score = world.PlayerScore;
+}
+
+#endif
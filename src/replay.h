@@ -0,0 +1,167 @@
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include "world.h"
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <string>
+
+// Binary input log for World: the seed and world size it started from, then
+// one record per Step() (and per Reset()). Feeding the same records to a World
+// built the same way reproduces the session bit-exactly on the same build,
+// which is what the headless replay driver in bench/ relies on.
+//
+// Layout (little-endian, as written by the machine that recorded it):
+//   header  ReplayHeader
+//   record  uint8 flags, then only the fields that changed since the last
+//           record: dt (float), move (2 floats), aim (3 floats)
+// A record with kReplayReset set stands for World::Reset() and carries no step.
+
+const uint32_t kReplayMagic = 0x594C5052; // "RPLY"
+const uint32_t kReplayVersion = 1;
+
+enum ReplayFlags : uint8_t {
+    kReplayDt    = 1 << 0,
+    kReplayMove  = 1 << 1,
+    kReplayAim   = 1 << 2,
+    kReplayReset = 1 << 3,
+};
+
+struct ReplayHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t seed;
+    uint32_t enemyCount;
+    uint32_t bulletCapacity;
+};
+
+struct ReplayTick {
+    bool reset = false;
+    float dt = 0.0f;
+    PlayerInput input;
+};
+
+class InputRecorder
+{
+public:
+    InputRecorder() : mTicks(0) {}
+
+    // world must have just been seeded with seed and Reset()
+    bool Open(const std::string& path, uint64_t seed, const World& world)
+    {
+        mOut.open(path, std::ios::binary | std::ios::trunc);
+        if (!mOut) return false;
+
+        ReplayHeader header = { kReplayMagic, kReplayVersion, seed,
+            (uint32_t)world.Enemies.Size(), (uint32_t)world.Bullets.Capacity() };
+        mOut.write((const char*)&header, sizeof(header));
+        mLast = ReplayTick();
+        mTicks = 0;
+        return (bool)mOut;
+    }
+
+    bool IsOpen() const { return mOut.is_open(); }
+    int Ticks() const { return mTicks; }
+
+    // call right before World::Step with the same arguments
+    void Step(float dt, const PlayerInput& input)
+    {
+        if (!mOut.is_open()) return;
+
+        uint8_t flags = 0;
+        if (!sameBits(&dt, &mLast.dt, sizeof(dt))) flags |= kReplayDt;
+        if (!sameBits(&input.move, &mLast.input.move, sizeof(input.move))) flags |= kReplayMove;
+        if (!sameBits(&input.aim, &mLast.input.aim, sizeof(input.aim))) flags |= kReplayAim;
+
+        mOut.put((char)flags);
+        if (flags & kReplayDt) mOut.write((const char*)&dt, sizeof(dt));
+        if (flags & kReplayMove) mOut.write((const char*)&input.move, sizeof(input.move));
+        if (flags & kReplayAim) mOut.write((const char*)&input.aim, sizeof(input.aim));
+
+        mLast.dt = dt;
+        mLast.input = input;
+        mTicks++;
+    }
+
+    // call alongside World::Reset
+    void Reset()
+    {
+        if (!mOut.is_open()) return;
+        mOut.put((char)kReplayReset);
+    }
+
+    void Close()
+    {
+        if (mOut.is_open()) mOut.close();
+    }
+
+private:
+    std::ofstream mOut;
+    ReplayTick mLast;
+    int mTicks;
+
+    static bool sameBits(const void* a, const void* b, size_t n)
+    {
+        return std::memcmp(a, b, n) == 0;
+    }
+};
+
+class InputReplayer
+{
+public:
+    bool Open(const std::string& path)
+    {
+        mIn.open(path, std::ios::binary);
+        if (!mIn) return false;
+        mIn.read((char*)&mHeader, sizeof(mHeader));
+        mLast = ReplayTick();
+        return mIn && mHeader.magic == kReplayMagic && mHeader.version == kReplayVersion;
+    }
+
+    const ReplayHeader& Header() const { return mHeader; }
+
+    // a World set up exactly like the recorded one
+    void Setup(World& world) const
+    {
+        world.Seed(mHeader.seed);
+        world.Reset();
+    }
+
+    // false at the end of the log (or on a truncated record)
+    bool Next(ReplayTick& tick)
+    {
+        int flags = mIn.get();
+        if (flags == std::char_traits<char>::eof()) return false;
+
+        if (flags & kReplayReset) {
+            tick = mLast;
+            tick.reset = true;
+            return true;
+        }
+        if (flags & kReplayDt) mIn.read((char*)&mLast.dt, sizeof(mLast.dt));
+        if (flags & kReplayMove) mIn.read((char*)&mLast.input.move, sizeof(mLast.input.move));
+        if (flags & kReplayAim) mIn.read((char*)&mLast.input.aim, sizeof(mLast.input.aim));
+        if (!mIn) return false;
+
+        tick = mLast;
+        tick.reset = false;
+        return true;
+    }
+
+    // rewind to the first record
+    void Rewind()
+    {
+        mIn.clear();
+        mIn.seekg(sizeof(ReplayHeader));
+        mLast = ReplayTick();
+    }
+
+private:
+    std::ifstream mIn;
+    ReplayHeader mHeader;
+    ReplayTick mLast;
+};
+
+#endif
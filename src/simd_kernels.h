@@ -0,0 +1,257 @@
+#ifndef SIMD_KERNELS_H
+#define SIMD_KERNELS_H
+
+#include <glm/glm.hpp>
+
+#include <cmath>
+#include <cstdint>
+
+// Structure-of-arrays kernels for the simulation's per-entity loops.
+//
+// Each kernel works on [begin, end) of plain float arrays so it can be handed
+// a slice by a parallel-for. The instruction set is picked at compile time:
+// AVX2 (8 lanes) when built with -mavx2 / /arch:AVX2, SSE2 (4 lanes) on any
+// x86-64 build, and a scalar loop everywhere else and for the tail. The vector
+// and scalar paths use the same operations in the same order, so a lane gives
+// the same bits as the scalar loop (as long as the compiler doesn't fuse the
+// scalar multiply-adds, i.e. no -ffp-contract=fast together with -mfma).
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define SIMD_KERNELS_AVX2 1
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define SIMD_KERNELS_SSE2 1
+#endif
+
+inline const char* simdInstructionSet()
+{
+#if defined(SIMD_KERNELS_AVX2)
+    return "AVX2";
+#elif defined(SIMD_KERNELS_SSE2)
+    return "SSE2";
+#else
+    return "scalar";
+#endif
+}
+
+const float kInvTwoPi = 0.159154943092f;
+const float kHalfPi = 1.57079632679f;
+const float kPi = 3.14159265359f;
+// 2*pi split in two so k * 2*pi can be subtracted without losing the low bits
+const float kTwoPiHi = 6.28125f;
+const float kTwoPiLo = 0.00193530717959f;
+// odd polynomial for sin on [-pi/2, pi/2], max error ~1e-6
+const float kSin3 = -1.66666667e-1f;
+const float kSin5 = 8.33333333e-3f;
+const float kSin7 = -1.98412698e-4f;
+const float kSin9 = 2.75573192e-6f;
+
+// sin(x) for |x| up to a few thousand: reduce to [-pi, pi], fold to [-pi/2, pi/2], polynomial
+inline float sinApprox(float x)
+{
+    float k = std::nearbyint(x * kInvTwoPi);
+    x = (x - k * kTwoPiHi) - k * kTwoPiLo;
+    if (x > kHalfPi) x = kPi - x;
+    if (x < -kHalfPi) x = -kPi - x;
+    float x2 = x * x;
+    float p = kSin9;
+    p = p * x2 + kSin7;
+    p = p * x2 + kSin5;
+    p = p * x2 + kSin3;
+    return x + (x * x2) * p;
+}
+
+#if defined(SIMD_KERNELS_AVX2)
+inline __m256 sinApprox8(__m256 x)
+{
+    __m256 k = _mm256_round_ps(_mm256_mul_ps(x, _mm256_set1_ps(kInvTwoPi)), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+    x = _mm256_sub_ps(_mm256_sub_ps(x, _mm256_mul_ps(k, _mm256_set1_ps(kTwoPiHi))), _mm256_mul_ps(k, _mm256_set1_ps(kTwoPiLo)));
+    x = _mm256_blendv_ps(x, _mm256_sub_ps(_mm256_set1_ps(kPi), x), _mm256_cmp_ps(x, _mm256_set1_ps(kHalfPi), _CMP_GT_OQ));
+    x = _mm256_blendv_ps(x, _mm256_sub_ps(_mm256_set1_ps(-kPi), x), _mm256_cmp_ps(x, _mm256_set1_ps(-kHalfPi), _CMP_LT_OQ));
+    __m256 x2 = _mm256_mul_ps(x, x);
+    __m256 p = _mm256_set1_ps(kSin9);
+    p = _mm256_add_ps(_mm256_mul_ps(p, x2), _mm256_set1_ps(kSin7));
+    p = _mm256_add_ps(_mm256_mul_ps(p, x2), _mm256_set1_ps(kSin5));
+    p = _mm256_add_ps(_mm256_mul_ps(p, x2), _mm256_set1_ps(kSin3));
+    return _mm256_add_ps(x, _mm256_mul_ps(_mm256_mul_ps(x, x2), p));
+}
+
+// one byte (0 / 1) per lane of a compare mask; returns how many were set
+inline int storeMask8(__m256 mask, uint8_t* out)
+{
+    int bits = _mm256_movemask_ps(mask);
+    int n = 0;
+    for (int k = 0; k < 8; ++k) {
+        out[k] = (uint8_t)((bits >> k) & 1);
+        n += out[k];
+    }
+    return n;
+}
+#elif defined(SIMD_KERNELS_SSE2)
+inline __m128 select4(__m128 mask, __m128 a, __m128 b) // mask ? b : a
+{
+    return _mm_or_ps(_mm_andnot_ps(mask, a), _mm_and_ps(mask, b));
+}
+
+inline __m128 sinApprox4(__m128 x)
+{
+    // cvtps rounds to nearest even under the default MXCSR, like nearbyint
+    __m128 k = _mm_cvtepi32_ps(_mm_cvtps_epi32(_mm_mul_ps(x, _mm_set1_ps(kInvTwoPi))));
+    x = _mm_sub_ps(_mm_sub_ps(x, _mm_mul_ps(k, _mm_set1_ps(kTwoPiHi))), _mm_mul_ps(k, _mm_set1_ps(kTwoPiLo)));
+    x = select4(_mm_cmpgt_ps(x, _mm_set1_ps(kHalfPi)), x, _mm_sub_ps(_mm_set1_ps(kPi), x));
+    x = select4(_mm_cmplt_ps(x, _mm_set1_ps(-kHalfPi)), x, _mm_sub_ps(_mm_set1_ps(-kPi), x));
+    __m128 x2 = _mm_mul_ps(x, x);
+    __m128 p = _mm_set1_ps(kSin9);
+    p = _mm_add_ps(_mm_mul_ps(p, x2), _mm_set1_ps(kSin7));
+    p = _mm_add_ps(_mm_mul_ps(p, x2), _mm_set1_ps(kSin5));
+    p = _mm_add_ps(_mm_mul_ps(p, x2), _mm_set1_ps(kSin3));
+    return _mm_add_ps(x, _mm_mul_ps(_mm_mul_ps(x, x2), p));
+}
+
+inline int storeMask4(__m128 mask, uint8_t* out)
+{
+    int bits = _mm_movemask_ps(mask);
+    int n = 0;
+    for (int k = 0; k < 4; ++k) {
+        out[k] = (uint8_t)((bits >> k) & 1);
+        n += out[k];
+    }
+    return n;
+}
+#endif
+
+// bullets: prev = pos, then pos += dir * (speed * dt)
+inline void integrateBullets(float* x, float* y, float* z, float* px, float* py, float* pz,
+                             const float* dx, const float* dy, const float* dz, const float* speed,
+                             int begin, int end, float dt)
+{
+    int i = begin;
+#if defined(SIMD_KERNELS_AVX2)
+    const __m256 vdt = _mm256_set1_ps(dt);
+    for (; i + 8 <= end; i += 8) {
+        __m256 vx = _mm256_loadu_ps(x + i), vy = _mm256_loadu_ps(y + i), vz = _mm256_loadu_ps(z + i);
+        _mm256_storeu_ps(px + i, vx); _mm256_storeu_ps(py + i, vy); _mm256_storeu_ps(pz + i, vz);
+        __m256 step = _mm256_mul_ps(_mm256_loadu_ps(speed + i), vdt);
+        _mm256_storeu_ps(x + i, _mm256_add_ps(vx, _mm256_mul_ps(_mm256_loadu_ps(dx + i), step)));
+        _mm256_storeu_ps(y + i, _mm256_add_ps(vy, _mm256_mul_ps(_mm256_loadu_ps(dy + i), step)));
+        _mm256_storeu_ps(z + i, _mm256_add_ps(vz, _mm256_mul_ps(_mm256_loadu_ps(dz + i), step)));
+    }
+#elif defined(SIMD_KERNELS_SSE2)
+    const __m128 vdt = _mm_set1_ps(dt);
+    for (; i + 4 <= end; i += 4) {
+        __m128 vx = _mm_loadu_ps(x + i), vy = _mm_loadu_ps(y + i), vz = _mm_loadu_ps(z + i);
+        _mm_storeu_ps(px + i, vx); _mm_storeu_ps(py + i, vy); _mm_storeu_ps(pz + i, vz);
+        __m128 step = _mm_mul_ps(_mm_loadu_ps(speed + i), vdt);
+        _mm_storeu_ps(x + i, _mm_add_ps(vx, _mm_mul_ps(_mm_loadu_ps(dx + i), step)));
+        _mm_storeu_ps(y + i, _mm_add_ps(vy, _mm_mul_ps(_mm_loadu_ps(dy + i), step)));
+        _mm_storeu_ps(z + i, _mm_add_ps(vz, _mm_mul_ps(_mm_loadu_ps(dz + i), step)));
+    }
+#endif
+    for (; i < end; ++i) {
+        px[i] = x[i]; py[i] = y[i]; pz[i] = z[i];
+        float step = speed[i] * dt;
+        x[i] += dx[i] * step;
+        y[i] += dy[i] * step;
+        z[i] += dz[i] * step;
+    }
+}
+
+// enemies: prev = pos, pos += step, then sway sideways by amplitude * sin(phase + z)
+inline void integrateEnemies(float* x, float* y, float* z, float* px, float* py, float* pz,
+                             int begin, int end, const glm::vec3& step, float phase, float amplitude)
+{
+    int i = begin;
+#if defined(SIMD_KERNELS_AVX2)
+    const __m256 sx = _mm256_set1_ps(step.x), sy = _mm256_set1_ps(step.y), sz = _mm256_set1_ps(step.z);
+    const __m256 vphase = _mm256_set1_ps(phase), vamp = _mm256_set1_ps(amplitude);
+    for (; i + 8 <= end; i += 8) {
+        __m256 vx = _mm256_loadu_ps(x + i), vy = _mm256_loadu_ps(y + i), vz = _mm256_loadu_ps(z + i);
+        _mm256_storeu_ps(px + i, vx); _mm256_storeu_ps(py + i, vy); _mm256_storeu_ps(pz + i, vz);
+        vx = _mm256_add_ps(vx, sx);
+        vy = _mm256_add_ps(vy, sy);
+        vz = _mm256_add_ps(vz, sz);
+        vx = _mm256_add_ps(vx, _mm256_mul_ps(sinApprox8(_mm256_add_ps(vphase, vz)), vamp));
+        _mm256_storeu_ps(x + i, vx); _mm256_storeu_ps(y + i, vy); _mm256_storeu_ps(z + i, vz);
+    }
+#elif defined(SIMD_KERNELS_SSE2)
+    const __m128 sx = _mm_set1_ps(step.x), sy = _mm_set1_ps(step.y), sz = _mm_set1_ps(step.z);
+    const __m128 vphase = _mm_set1_ps(phase), vamp = _mm_set1_ps(amplitude);
+    for (; i + 4 <= end; i += 4) {
+        __m128 vx = _mm_loadu_ps(x + i), vy = _mm_loadu_ps(y + i), vz = _mm_loadu_ps(z + i);
+        _mm_storeu_ps(px + i, vx); _mm_storeu_ps(py + i, vy); _mm_storeu_ps(pz + i, vz);
+        vx = _mm_add_ps(vx, sx);
+        vy = _mm_add_ps(vy, sy);
+        vz = _mm_add_ps(vz, sz);
+        vx = _mm_add_ps(vx, _mm_mul_ps(sinApprox4(_mm_add_ps(vphase, vz)), vamp));
+        _mm_storeu_ps(x + i, vx); _mm_storeu_ps(y + i, vy); _mm_storeu_ps(z + i, vz);
+    }
+#endif
+    for (; i < end; ++i) {
+        px[i] = x[i]; py[i] = y[i]; pz[i] = z[i];
+        x[i] += step.x;
+        y[i] += step.y;
+        z[i] += step.z;
+        x[i] += sinApprox(phase + z[i]) * amplitude;
+    }
+}
+
+// bounds culling: out[i] = v[i] < lo || v[i] > hi; returns the number flagged
+inline int outsideRange(const float* v, int begin, int end, float lo, float hi, uint8_t* out)
+{
+    int n = 0;
+    int i = begin;
+#if defined(SIMD_KERNELS_AVX2)
+    const __m256 vlo = _mm256_set1_ps(lo), vhi = _mm256_set1_ps(hi);
+    for (; i + 8 <= end; i += 8) {
+        __m256 a = _mm256_loadu_ps(v + i);
+        n += storeMask8(_mm256_or_ps(_mm256_cmp_ps(a, vlo, _CMP_LT_OQ), _mm256_cmp_ps(a, vhi, _CMP_GT_OQ)), out + i);
+    }
+#elif defined(SIMD_KERNELS_SSE2)
+    const __m128 vlo = _mm_set1_ps(lo), vhi = _mm_set1_ps(hi);
+    for (; i + 4 <= end; i += 4) {
+        __m128 a = _mm_loadu_ps(v + i);
+        n += storeMask4(_mm_or_ps(_mm_cmplt_ps(a, vlo), _mm_cmpgt_ps(a, vhi)), out + i);
+    }
+#endif
+    for (; i < end; ++i) {
+        out[i] = (uint8_t)(v[i] < lo || v[i] > hi);
+        n += out[i];
+    }
+    return n;
+}
+
+// squared-distance test: out[i] = |p[i] - c|^2 < r2; returns the number flagged
+inline int withinRadius(const float* x, const float* y, const float* z, int begin, int end,
+                        const glm::vec3& c, float r2, uint8_t* out)
+{
+    int n = 0;
+    int i = begin;
+#if defined(SIMD_KERNELS_AVX2)
+    const __m256 cx = _mm256_set1_ps(c.x), cy = _mm256_set1_ps(c.y), cz = _mm256_set1_ps(c.z), vr2 = _mm256_set1_ps(r2);
+    for (; i + 8 <= end; i += 8) {
+        __m256 dx = _mm256_sub_ps(_mm256_loadu_ps(x + i), cx);
+        __m256 dy = _mm256_sub_ps(_mm256_loadu_ps(y + i), cy);
+        __m256 dz = _mm256_sub_ps(_mm256_loadu_ps(z + i), cz);
+        __m256 d2 = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy)), _mm256_mul_ps(dz, dz));
+        n += storeMask8(_mm256_cmp_ps(d2, vr2, _CMP_LT_OQ), out + i);
+    }
+#elif defined(SIMD_KERNELS_SSE2)
+    const __m128 cx = _mm_set1_ps(c.x), cy = _mm_set1_ps(c.y), cz = _mm_set1_ps(c.z), vr2 = _mm_set1_ps(r2);
+    for (; i + 4 <= end; i += 4) {
+        __m128 dx = _mm_sub_ps(_mm_loadu_ps(x + i), cx);
+        __m128 dy = _mm_sub_ps(_mm_loadu_ps(y + i), cy);
+        __m128 dz = _mm_sub_ps(_mm_loadu_ps(z + i), cz);
+        __m128 d2 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
+        n += storeMask4(_mm_cmplt_ps(d2, vr2), out + i);
+    }
+#endif
+    for (; i < end; ++i) {
+        float dx = x[i] - c.x, dy = y[i] - c.y, dz = z[i] - c.z;
+        out[i] = (uint8_t)(dx * dx + dy * dy + dz * dz < r2);
+        n += out[i];
+    }
+    return n;
+}
+
+#endif
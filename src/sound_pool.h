@@ -0,0 +1,124 @@
+#ifndef SOUND_POOL_H
+#define SOUND_POOL_H
+
+#include "audio.h"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+// Preloaded one-shot sound effects played through a capped voice pool.
+//
+// Load() decodes the file into memory once, so playing it never touches the
+// file system or the decoder again. Gameplay Queue()s plays as they happen and
+// Flush() starts them: everything one sound got since the last Flush() becomes
+// a single voice, slightly louder for a burst, instead of one voice per hit
+// (the boost is capped at 1.0, so Load() effects below full volume).
+// Each sound has its own voice limit (and the pool a global one); at the limit
+// the sound's oldest voice is cut and reused.
+class SoundPool
+{
+public:
+    static const int kMaxVoices = 16; // all sounds together
+
+    SoundPool() : mAudio(nullptr) {}
+
+    void Init(AudioBackend* audio)
+    {
+        mAudio = audio;
+    }
+
+    // decode path now; returns the id to Queue() with, or -1 (Queue ignores -1)
+    int Load(const std::string& path, int maxVoices, float volume = 1.0f)
+    {
+        if (!mAudio) return -1;
+        int source = mAudio->Load(path);
+        if (source < 0) return -1;
+
+        Sound s;
+        s.source = source;
+        s.maxVoices = std::max(1, maxVoices);
+        s.volume = volume;
+        mSounds.push_back(s);
+        return (int)mSounds.size() - 1;
+    }
+
+    void Queue(int id, int count = 1)
+    {
+        if (id < 0 || count <= 0) return;
+        mSounds[id].pending += count;
+    }
+
+    // start everything queued since the last call; once per tick or frame
+    void Flush()
+    {
+        if (!mAudio) return;
+        reapFinished();
+
+        for (Sound& s : mSounds) {
+            if (s.pending == 0) continue;
+            int hits = s.pending;
+            s.pending = 0;
+
+            if ((int)s.voices.size() >= s.maxVoices || activeVoices() >= kMaxVoices) {
+                if (s.voices.empty()) continue; // pool full of other sounds: drop this one
+                stopVoice(s, 0);
+            }
+
+            int voice = mAudio->Play(s.source, std::min(1.0f, s.volume * (1.0f + 0.25f * (hits - 1))));
+            if (voice < 0) continue;
+            s.voices.push_back(voice);
+        }
+    }
+
+    int ActiveVoices() const
+    {
+        return activeVoices();
+    }
+
+    // stop every voice; call before destroying the backend
+    void Destroy()
+    {
+        for (Sound& s : mSounds)
+            while (!s.voices.empty()) stopVoice(s, 0);
+        mSounds.clear();
+        mAudio = nullptr;
+    }
+
+private:
+    struct Sound {
+        int source = -1;         // backend sound id
+        std::vector<int> voices; // backend voice ids, oldest first
+        int maxVoices = 1;
+        int pending = 0;
+        float volume = 1.0f;
+    };
+
+    AudioBackend* mAudio;
+    std::vector<Sound> mSounds;
+
+    int activeVoices() const
+    {
+        int n = 0;
+        for (const Sound& s : mSounds) n += (int)s.voices.size();
+        return n;
+    }
+
+    void stopVoice(Sound& s, int i)
+    {
+        mAudio->Stop(s.voices[i]);
+        s.voices.erase(s.voices.begin() + i);
+    }
+
+    void reapFinished()
+    {
+        for (Sound& s : mSounds) {
+            for (int i = (int)s.voices.size() - 1; i >= 0; --i) {
+                if (mAudio->IsPlaying(s.voices[i])) continue;
+                s.voices.erase(s.voices.begin() + i);
+            }
+        }
+    }
+};
+
+#endif
@@ -0,0 +1,107 @@
+#ifndef SPATIAL_HASH_H
+#define SPATIAL_HASH_H
+
+#include <glm/glm.hpp>
+
+#include <vector>
+#include <cmath>
+#include <cstdint>
+
+// Uniform-grid broad-phase, rebuilt from scratch every tick.
+// Points are bucketed by a hash of their cell, then counting-sorted so each
+// bucket is a contiguous run of ids. Hash collisions only add candidates, so
+// callers must still do the exact distance test (and may see an id twice).
+class SpatialHash
+{
+public:
+    SpatialHash(float cellSize = 1.0f) : mCellSize(cellSize), mInvCellSize(1.0f / cellSize), mMask(0) {}
+
+    float CellSize() const { return mCellSize; }
+
+    void Clear()
+    {
+        mItems.clear();
+    }
+
+    void Insert(int id, const glm::vec3& p)
+    {
+        Item item;
+        item.id = id;
+        item.bucket = hashCell(cellOf(p.x), cellOf(p.y), cellOf(p.z));
+        mItems.push_back(item);
+    }
+
+    // sort the inserted points into buckets; call once after the last Insert
+    void Build()
+    {
+        // ~2 buckets per point keeps chains short without a big table
+        unsigned int buckets = 64;
+        while (buckets < mItems.size() * 2) buckets <<= 1;
+        mMask = buckets - 1;
+
+        mBucketStart.assign(buckets + 1, 0);
+        for (Item& item : mItems) {
+            item.bucket &= mMask;
+            mBucketStart[item.bucket + 1]++;
+        }
+        for (unsigned int b = 0; b < buckets; ++b)
+            mBucketStart[b + 1] += mBucketStart[b];
+
+        mSorted.resize(mItems.size());
+        mCursor.assign(mBucketStart.begin(), mBucketStart.end() - 1);
+        for (const Item& item : mItems)
+            mSorted[mCursor[item.bucket]++] = item.id;
+    }
+
+    // call f(id) for every point that may lie within radius r of p
+    template <typename F>
+    void ForEachNear(const glm::vec3& p, float r, F&& f) const
+    {
+        ForEachInBox(p - glm::vec3(r), p + glm::vec3(r), f);
+    }
+
+    // call f(id) for every point that may lie inside the box [lo, hi]
+    template <typename F>
+    void ForEachInBox(const glm::vec3& lo, const glm::vec3& hi, F&& f) const
+    {
+        if (mSorted.empty()) return;
+
+        int x0 = cellOf(lo.x), x1 = cellOf(hi.x);
+        int y0 = cellOf(lo.y), y1 = cellOf(hi.y);
+        int z0 = cellOf(lo.z), z1 = cellOf(hi.z);
+        for (int z = z0; z <= z1; ++z)
+            for (int y = y0; y <= y1; ++y)
+                for (int x = x0; x <= x1; ++x)
+                {
+                    uint32_t b = hashCell(x, y, z) & mMask;
+                    for (uint32_t i = mBucketStart[b]; i < mBucketStart[b + 1]; ++i)
+                        f(mSorted[i]);
+                }
+    }
+
+private:
+    struct Item {
+        int id;
+        uint32_t bucket;
+    };
+
+    float mCellSize;
+    float mInvCellSize;
+    uint32_t mMask;
+    std::vector<Item> mItems;
+    std::vector<uint32_t> mBucketStart;
+    std::vector<uint32_t> mCursor;
+    std::vector<int> mSorted;
+
+    int cellOf(float v) const
+    {
+        return (int)std::floor(v * mInvCellSize);
+    }
+
+    static uint32_t hashCell(int x, int y, int z)
+    {
+        return ((uint32_t)x * 73856093u) ^ ((uint32_t)y * 19349663u) ^ ((uint32_t)z * 83492791u);
+    }
+};
+
+#endif
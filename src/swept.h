@@ -0,0 +1,65 @@
+#ifndef SWEPT_H
+#define SWEPT_H
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+// Continuous (swept) collision tests for bullets. A bullet is the segment it
+// covered during the tick, p0 -> p1, so a fast bullet or a long tick can't step
+// over a target the way an end-of-tick distance check can.
+
+// Segment p0 -> p1 against the sphere (c, r). On a hit, t is the fraction of
+// the segment at which it enters the sphere (0 when it starts inside).
+inline bool segmentSphere(const glm::vec3& p0, const glm::vec3& p1, const glm::vec3& c, float r, float& t)
+{
+    glm::vec3 d = p1 - p0;
+    glm::vec3 m = p0 - c;
+    float c2 = glm::dot(m, m) - r * r;
+    if (c2 <= 0.0f) { t = 0.0f; return true; }
+
+    float a = glm::dot(d, d);
+    float b = glm::dot(m, d);
+    if (a <= 0.0f || b >= 0.0f) return false; // not moving, or moving away
+
+    float disc = b * b - a * c2;
+    if (disc < 0.0f) return false;
+
+    t = (-b - std::sqrt(disc)) / a;
+    return t <= 1.0f;
+}
+
+// Batched form for many bullets against one target that itself moved c0 -> c1
+// this tick (tested in the target's frame, so both motions are accounted for).
+// Bullets are SoA start / end arrays; hits[i] is set to 1 or 0. The loop body
+// is branch-free (closest approach on the relative segment) so the compiler
+// can vectorise it. Returns the number of hits.
+inline int sweptSphereBatch(const float* x0, const float* y0, const float* z0,
+                            const float* x1, const float* y1, const float* z1,
+                            int count, const glm::vec3& c0, const glm::vec3& c1, float r,
+                            uint8_t* hits)
+{
+    const float r2 = r * r;
+    int total = 0;
+    for (int i = 0; i < count; ++i)
+    {
+        // relative segment: start and end in the target's frame
+        float mx = x0[i] - c0.x, my = y0[i] - c0.y, mz = z0[i] - c0.z;
+        float dx = (x1[i] - c1.x) - mx, dy = (y1[i] - c1.y) - my, dz = (z1[i] - c1.z) - mz;
+
+        float a = dx * dx + dy * dy + dz * dz;
+        float b = mx * dx + my * dy + mz * dz;
+        // closest point on the segment to the target's centre
+        float t = std::min(1.0f, std::max(0.0f, -b / std::max(a, 1e-12f)));
+        float qx = mx + t * dx, qy = my + t * dy, qz = mz + t * dz;
+
+        uint8_t hit = (qx * qx + qy * qy + qz * qz) < r2;
+        hits[i] = hit;
+        total += hit;
+    }
+    return total;
+}
+
+#endif
@@ -0,0 +1,211 @@
+#ifndef TEXT_RENDERER_H
+#define TEXT_RENDERER_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <ft2build.h>
+#include FT_FREETYPE_H
+
+#include "cached_shader.h"
+
+#include <algorithm>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// glyph metrics in pixels plus its rectangle in the atlas texture
+struct Character {
+    glm::ivec2   Size;
+    glm::ivec2   Bearing;
+    unsigned int Advance;
+    glm::vec2    UvMin; // top-left
+    glm::vec2    UvMax; // bottom-right
+};
+
+// All ASCII glyphs of one font packed into a single GL_RED texture, and a
+// batcher that collects every string of the frame into one vertex buffer so
+// the whole HUD is a single draw call.
+class TextRenderer
+{
+public:
+    TextRenderer() : mTexture(0), mVAO(0), mVBO(0), mCapacity(0) {}
+
+    bool Init(const std::string& fontPath, unsigned int pixelSize)
+    {
+        if (!loadAtlas(fontPath, pixelSize))
+            return false;
+
+        glGenVertexArrays(1, &mVAO);
+        glGenBuffers(1, &mVBO);
+        glBindVertexArray(mVAO);
+        glBindBuffer(GL_ARRAY_BUFFER, mVBO);
+        // (x, y, u, v)
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, kFloatsPerVertex * sizeof(float), (void*)0);
+        // (r, g, b)
+        glEnableVertexAttribArray(1);
+        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, kFloatsPerVertex * sizeof(float), (void*)(4 * sizeof(float)));
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        glBindVertexArray(0);
+        return true;
+    }
+
+    void Destroy()
+    {
+        glDeleteTextures(1, &mTexture);
+        glDeleteBuffers(1, &mVBO);
+        glDeleteVertexArrays(1, &mVAO);
+        mTexture = mVAO = mVBO = 0;
+    }
+
+    const Character& Glyph(char c) const
+    {
+        unsigned char i = (unsigned char)c;
+        return mGlyphs[i < kGlyphCount ? i : '?'];
+    }
+
+    // queue a string at pixel position (x, y) (baseline, left); drawn by the next Draw()
+    void Add(const std::string& text, float x, float y, float scale, glm::vec3 color)
+    {
+        for (char c : text) {
+            const Character& ch = Glyph(c);
+
+            float xpos = x + ch.Bearing.x * scale;
+            float ypos = y - (ch.Size.y - ch.Bearing.y) * scale;
+
+            float w = ch.Size.x * scale;
+            float h = ch.Size.y * scale;
+
+            float u0 = ch.UvMin.x, v0 = ch.UvMin.y;
+            float u1 = ch.UvMax.x, v1 = ch.UvMax.y;
+
+            float quad[6][kFloatsPerVertex] = {
+                { xpos,     ypos + h,   u0, v0, color.r, color.g, color.b },
+                { xpos,     ypos,       u0, v1, color.r, color.g, color.b },
+                { xpos + w, ypos,       u1, v1, color.r, color.g, color.b },
+
+                { xpos,     ypos + h,   u0, v0, color.r, color.g, color.b },
+                { xpos + w, ypos,       u1, v1, color.r, color.g, color.b },
+                { xpos + w, ypos + h,   u1, v0, color.r, color.g, color.b }
+            };
+            mVertices.insert(mVertices.end(), &quad[0][0], &quad[0][0] + 6 * kFloatsPerVertex);
+
+            x += (ch.Advance >> 6) * scale;
+        }
+    }
+
+    // draw everything queued since the last Draw() in one call, then clear the queue
+    void Draw(CachedShader& shader)
+    {
+        if (mVertices.empty()) return;
+
+        shader.use();
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, mTexture);
+        glBindVertexArray(mVAO);
+        glBindBuffer(GL_ARRAY_BUFFER, mVBO);
+        if (mVertices.size() > mCapacity)
+            mCapacity = std::max(mVertices.size(), mCapacity * 2);
+        glBufferData(GL_ARRAY_BUFFER, mCapacity * sizeof(float), NULL, GL_STREAM_DRAW);
+        glBufferSubData(GL_ARRAY_BUFFER, 0, mVertices.size() * sizeof(float), mVertices.data());
+        glDrawArrays(GL_TRIANGLES, 0, (GLsizei)(mVertices.size() / kFloatsPerVertex));
+
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        glBindVertexArray(0);
+        glBindTexture(GL_TEXTURE_2D, 0);
+        mVertices.clear();
+    }
+
+private:
+    static const unsigned int kGlyphCount = 128;
+    static const int kFloatsPerVertex = 7;
+    static const int kAtlasWidth = 1024;
+    static const int kPadding = 1; // keeps bilinear filtering from bleeding in the neighbour glyph
+
+    Character mGlyphs[kGlyphCount];
+    unsigned int mTexture;
+    unsigned int mVAO;
+    unsigned int mVBO;
+    size_t mCapacity; // in floats
+    std::vector<float> mVertices;
+
+    bool loadAtlas(const std::string& fontPath, unsigned int pixelSize)
+    {
+        FT_Library ft;
+        if (FT_Init_FreeType(&ft)) {
+            std::cout << "ERROR::FREETYPE: Could not init FreeType Library\n";
+            return false;
+        }
+
+        FT_Face face;
+        if (FT_New_Face(ft, fontPath.c_str(), 0, &face)) {
+            std::cout << "ERROR::FREETYPE: Failed to load font\n";
+            FT_Done_FreeType(ft);
+            return false;
+        }
+
+        FT_Set_Pixel_Sizes(face, 0, pixelSize);
+
+        // render every glyph once, copying the bitmaps out while shelf-packing them
+        std::vector<unsigned char> bitmaps[kGlyphCount];
+        glm::ivec2 offsets[kGlyphCount];
+        int penX = kPadding, penY = kPadding, rowHeight = 0;
+        for (unsigned int c = 0; c < kGlyphCount; c++) {
+            Character& ch = mGlyphs[c];
+            ch = Character();
+            if (FT_Load_Char(face, c, FT_LOAD_RENDER)) {
+                std::cout << "ERROR::FREETYPE: Failed to load Glyph\n";
+                continue;
+            }
+
+            const FT_Bitmap& bitmap = face->glyph->bitmap;
+            ch.Size = glm::ivec2(bitmap.width, bitmap.rows);
+            ch.Bearing = glm::ivec2(face->glyph->bitmap_left, face->glyph->bitmap_top);
+            ch.Advance = static_cast<unsigned int>(face->glyph->advance.x);
+
+            if (penX + ch.Size.x + kPadding > kAtlasWidth) {
+                penX = kPadding;
+                penY += rowHeight + kPadding;
+                rowHeight = 0;
+            }
+            offsets[c] = glm::ivec2(penX, penY);
+            penX += ch.Size.x + kPadding;
+            rowHeight = std::max(rowHeight, ch.Size.y);
+
+            bitmaps[c].resize(ch.Size.x * ch.Size.y);
+            for (int row = 0; row < ch.Size.y; row++)
+                std::copy(bitmap.buffer + row * bitmap.pitch, bitmap.buffer + row * bitmap.pitch + ch.Size.x,
+                    bitmaps[c].begin() + row * ch.Size.x);
+        }
+        int atlasHeight = 1;
+        while (atlasHeight < penY + rowHeight + kPadding) atlasHeight <<= 1;
+
+        FT_Done_Face(face);
+        FT_Done_FreeType(ft);
+
+        // upload the whole atlas in one go
+        std::vector<unsigned char> pixels(kAtlasWidth * atlasHeight, 0);
+        for (unsigned int c = 0; c < kGlyphCount; c++) {
+            Character& ch = mGlyphs[c];
+            for (int row = 0; row < ch.Size.y; row++)
+                std::copy(bitmaps[c].begin() + row * ch.Size.x, bitmaps[c].begin() + (row + 1) * ch.Size.x,
+                    pixels.begin() + (offsets[c].y + row) * kAtlasWidth + offsets[c].x);
+            ch.UvMin = glm::vec2((float)offsets[c].x / kAtlasWidth, (float)offsets[c].y / atlasHeight);
+            ch.UvMax = glm::vec2((float)(offsets[c].x + ch.Size.x) / kAtlasWidth, (float)(offsets[c].y + ch.Size.y) / atlasHeight);
+        }
+
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1); // disable byte-alignment restriction
+        glGenTextures(1, &mTexture);
+        glBindTexture(GL_TEXTURE_2D, mTexture);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RED, kAtlasWidth, atlasHeight, 0, GL_RED, GL_UNSIGNED_BYTE, pixels.data());
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glBindTexture(GL_TEXTURE_2D, 0);
+        return true;
+    }
+};
+
+#endif
@@ -0,0 +1,465 @@
+#ifndef TEXTURE_LOADER_H
+#define TEXTURE_LOADER_H
+
+#include <glad/glad.h>
+#include <stb_image.h>
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "mapped_file.h"
+
+// block-compressed formats; not all of them are in a 3.3 core loader
+#ifndef GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT 0x83F0
+#endif
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT5_EXT
+#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT 0x83F3
+#endif
+#ifndef GL_COMPRESSED_SRGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_SRGB_S3TC_DXT1_EXT 0x8C4C
+#endif
+#ifndef GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT
+#define GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT 0x8C4F
+#endif
+#ifndef GL_COMPRESSED_RGBA_BPTC_UNORM
+#define GL_COMPRESSED_RGBA_BPTC_UNORM 0x8E8C
+#endif
+#ifndef GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM
+#define GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM 0x8E8D
+#endif
+
+// Decodes image files on a small pool of worker threads and uploads them on
+// the GL thread.
+//
+// Texture2D() / Cubemap() create the GL texture right away and queue one
+// decode job per image (six per cubemap), so every skybox face decodes in
+// parallel. Update() uploads whatever has finished since the last call and
+// must be called from the thread that owns the GL context; Finish() keeps
+// calling it until everything is resident, reporting progress on the way
+// (e.g. to draw a loading bar).
+//
+// RGB images are stored as BC1 (DXT1) and RGBA as BC7, or BC3 (DXT5) without
+// BPTC, when the driver exposes them. The first run uploads the decoded pixels
+// with the compressed internal format, lets the driver encode them (and build
+// the mip chain), then reads every level back with glGetCompressedTexImage into
+// "<image>.ctex" next to the source. Later runs read that file on the worker
+// instead of decoding the image and upload it with glCompressedTexImage2D: no
+// PNG decode and no glGenerateMipmap. The cache records a hash of the source
+// file and the compressed format, so it is rebuilt when either changes.
+//
+// stbi_load itself is thread-safe, but stbi_set_flip_vertically_on_load is a
+// global: don't change it while jobs are in flight.
+class TextureLoader
+{
+public:
+    // (images uploaded, images queued)
+    typedef std::function<void(int, int)> ProgressFn;
+
+    TextureLoader(unsigned int threads = 0) : mStop(false), mQueued(0), mUploaded(0)
+    {
+        chooseCompressedFormats();
+        if (threads == 0)
+            threads = std::max(1u, std::min(4u, std::thread::hardware_concurrency()));
+        for (unsigned int i = 0; i < threads; i++)
+            mWorkers.emplace_back([this]() { workerLoop(); });
+    }
+
+    ~TextureLoader()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mStop = true;
+        }
+        mJobReady.notify_all();
+        for (std::thread& t : mWorkers)
+            t.join();
+        for (Decoded& d : mDecoded)
+            stbi_image_free(d.pixels);
+    }
+
+    // same result as the old loadTexture(): mipmapped, repeat wrap, (s)RGB(A) by component count
+    unsigned int Texture2D(const std::string& path, bool gammaCorrection)
+    {
+        unsigned int textureID;
+        glGenTextures(1, &textureID);
+        Target target = { textureID, GL_TEXTURE_2D, gammaCorrection };
+        mTargets.push_back(target);
+        queue((int)mTargets.size() - 1, 0, path, 0, gammaCorrection);
+        return textureID;
+    }
+
+    // faces in +X, -X, +Y, -Y, +Z, -Z order, like the old loadCubemap()
+    unsigned int Cubemap(const std::vector<std::string>& faces)
+    {
+        unsigned int textureID;
+        glGenTextures(1, &textureID);
+        glBindTexture(GL_TEXTURE_CUBE_MAP, textureID);
+        glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+        glBindTexture(GL_TEXTURE_CUBE_MAP, 0);
+
+        Target target = { textureID, GL_TEXTURE_CUBE_MAP, false };
+        mTargets.push_back(target);
+        for (unsigned int i = 0; i < faces.size(); i++)
+            queue((int)mTargets.size() - 1, (int)i, faces[i], 3, false); // faces are uploaded as GL_RGB
+        return textureID;
+    }
+
+    int Queued() const { return mQueued; }
+    int Uploaded() const { return mUploaded; }
+    bool Done() const { return mUploaded == mQueued; }
+
+    // upload every image decoded so far; GL thread only
+    void Update()
+    {
+        std::deque<Decoded> ready;
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            ready.swap(mDecoded);
+        }
+        for (Decoded& d : ready) {
+            if (!d.levels.empty())
+                uploadCompressed(d);
+            else
+                upload(d);
+            stbi_image_free(d.pixels);
+            mUploaded++;
+        }
+    }
+
+    // block (while still pumping uploads and progress) until every queued image is on the GPU
+    void Finish(const ProgressFn& progress = ProgressFn())
+    {
+        for (;;) {
+            Update();
+            if (progress) progress(mUploaded, mQueued);
+            if (Done()) break;
+
+            std::unique_lock<std::mutex> lock(mMutex);
+            mDecodedReady.wait_for(lock, std::chrono::milliseconds(16), [this]() { return !mDecoded.empty(); });
+        }
+    }
+
+private:
+    struct Target {
+        unsigned int id;
+        GLenum kind;
+        bool gamma;
+    };
+
+    struct Job {
+        int target;
+        int face;
+        std::string path;
+        int components; // 0 = keep the file's
+        GLenum rgbFormat;  // compressed format for 3 / 4 component images, 0 = none
+        GLenum rgbaFormat;
+    };
+
+    struct Level {
+        uint32_t width, height;
+        uint32_t offset, size; // into Decoded::compressed
+    };
+
+    struct Decoded {
+        int target;
+        int face;
+        std::string path;
+        unsigned char* pixels; // stb output on a cache miss
+        int width, height, components;
+        uint64_t sourceHash;
+        GLenum rgbFormat, rgbaFormat;
+        GLenum compressedFormat; // on a cache hit: the .ctex contents
+        std::vector<Level> levels;
+        std::vector<unsigned char> compressed;
+    };
+
+    struct CacheHeader {
+        uint32_t magic;
+        uint32_t version;
+        uint64_t sourceHash;
+        uint32_t format;
+        uint32_t levelCount;
+    };
+
+    static const uint32_t kCacheMagic = 0x58455443; // "CTEX"
+    static const uint32_t kCacheVersion = 1;
+
+    std::vector<std::thread> mWorkers;
+    std::mutex mMutex;
+    std::condition_variable mJobReady;
+    std::condition_variable mDecodedReady;
+    std::deque<Job> mJobs;
+    std::deque<Decoded> mDecoded;
+    bool mStop;
+
+    // GL thread only
+    GLenum mRgbFormat[2];  // [gamma]
+    GLenum mRgbaFormat[2];
+    std::vector<Target> mTargets;
+    int mQueued;
+    int mUploaded;
+
+    static bool hasExtension(const char* name)
+    {
+        GLint count = 0;
+        glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+        for (GLint i = 0; i < count; i++) {
+            const char* ext = (const char*)glGetStringi(GL_EXTENSIONS, i);
+            if (ext && std::strcmp(ext, name) == 0) return true;
+        }
+        return false;
+    }
+
+    void chooseCompressedFormats()
+    {
+        bool s3tc = hasExtension("GL_EXT_texture_compression_s3tc");
+        bool s3tcSrgb = s3tc && (hasExtension("GL_EXT_texture_sRGB") || hasExtension("GL_EXT_texture_compression_s3tc_srgb"));
+        GLint major = 0, minor = 0;
+        glGetIntegerv(GL_MAJOR_VERSION, &major);
+        glGetIntegerv(GL_MINOR_VERSION, &minor);
+        bool bptc = major > 4 || (major == 4 && minor >= 2) || hasExtension("GL_ARB_texture_compression_bptc");
+
+        mRgbFormat[0] = s3tc ? GL_COMPRESSED_RGB_S3TC_DXT1_EXT : 0;
+        mRgbFormat[1] = s3tcSrgb ? GL_COMPRESSED_SRGB_S3TC_DXT1_EXT : 0;
+        mRgbaFormat[0] = bptc ? GL_COMPRESSED_RGBA_BPTC_UNORM : (s3tc ? GL_COMPRESSED_RGBA_S3TC_DXT5_EXT : 0);
+        mRgbaFormat[1] = bptc ? GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM : (s3tcSrgb ? GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT : 0);
+    }
+
+    void queue(int target, int face, const std::string& path, int components, bool gamma)
+    {
+        Job job = { target, face, path, components, mRgbFormat[gamma], mRgbaFormat[gamma] };
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mJobs.push_back(job);
+        }
+        mQueued++;
+        mJobReady.notify_one();
+    }
+
+    void workerLoop()
+    {
+        for (;;) {
+            Job job;
+            {
+                std::unique_lock<std::mutex> lock(mMutex);
+                mJobReady.wait(lock, [this]() { return mStop || !mJobs.empty(); });
+                if (mStop) return;
+                job = mJobs.front();
+                mJobs.pop_front();
+            }
+
+            Decoded d;
+            d.target = job.target;
+            d.face = job.face;
+            d.path = job.path;
+            d.pixels = nullptr;
+            d.width = d.height = d.components = 0;
+            d.sourceHash = 0;
+            d.rgbFormat = job.rgbFormat;
+            d.rgbaFormat = job.rgbaFormat;
+            d.compressedFormat = 0;
+
+            MappedFile source;
+            if (source.Open(job.path)) {
+                d.sourceHash = hashBytes(source.Data(), source.Size());
+                bool cached = (job.rgbFormat || job.rgbaFormat) && readCache(d);
+                if (!cached) {
+                    d.pixels = stbi_load_from_memory(source.Data(), (int)source.Size(), &d.width, &d.height, &d.components, job.components);
+                    if (job.components != 0) d.components = job.components;
+                }
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(mMutex);
+                mDecoded.push_back(d);
+            }
+            mDecodedReady.notify_one();
+        }
+    }
+
+    void upload(const Decoded& d)
+    {
+        const Target& target = mTargets[d.target];
+        if (!d.pixels) {
+            std::cout << (target.kind == GL_TEXTURE_CUBE_MAP ? "Cubemap texture" : "Texture")
+                      << " failed to load at path: " << d.path << std::endl;
+            return;
+        }
+
+        GLenum internalFormat = GL_RGB;
+        GLenum dataFormat = GL_RGB;
+        if (d.components == 1)
+        {
+            internalFormat = dataFormat = GL_RED;
+        }
+        else if (d.components == 3)
+        {
+            internalFormat = target.gamma ? GL_SRGB : GL_RGB;
+            dataFormat = GL_RGB;
+        }
+        else if (d.components == 4)
+        {
+            internalFormat = target.gamma ? GL_SRGB_ALPHA : GL_RGBA;
+            dataFormat = GL_RGBA;
+        }
+
+        GLenum uncompressedFormat = internalFormat;
+        GLenum compressedFormat = d.components == 3 ? d.rgbFormat : (d.components == 4 ? d.rgbaFormat : 0);
+        if (compressedFormat)
+            internalFormat = compressedFormat; // the driver encodes on upload
+
+        glBindTexture(target.kind, target.id);
+        if (target.kind == GL_TEXTURE_CUBE_MAP)
+        {
+            glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + d.face, 0, internalFormat, d.width, d.height, 0, dataFormat, GL_UNSIGNED_BYTE, d.pixels);
+        }
+        else
+        {
+            glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, d.width, d.height, 0, dataFormat, GL_UNSIGNED_BYTE, d.pixels);
+            glGenerateMipmap(GL_TEXTURE_2D);
+
+            // some drivers won't build mips for a compressed level 0: redo it uncompressed
+            GLint mipWidth = 1;
+            if (compressedFormat && (d.width > 1 || d.height > 1))
+                glGetTexLevelParameteriv(GL_TEXTURE_2D, 1, GL_TEXTURE_WIDTH, &mipWidth);
+            if (mipWidth == 0) {
+                compressedFormat = 0;
+                glTexImage2D(GL_TEXTURE_2D, 0, uncompressedFormat, d.width, d.height, 0, dataFormat, GL_UNSIGNED_BYTE, d.pixels);
+                glGenerateMipmap(GL_TEXTURE_2D);
+            }
+
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        }
+        if (compressedFormat)
+            writeCache(d, compressedFormat);
+        glBindTexture(target.kind, 0);
+    }
+
+    void uploadCompressed(const Decoded& d)
+    {
+        const Target& target = mTargets[d.target];
+        const unsigned char* base = d.compressed.data();
+
+        GLenum face = target.kind == GL_TEXTURE_CUBE_MAP ? GL_TEXTURE_CUBE_MAP_POSITIVE_X + d.face : GL_TEXTURE_2D;
+        glBindTexture(target.kind, target.id);
+        for (unsigned int level = 0; level < d.levels.size(); level++) {
+            const Level& l = d.levels[level];
+            glCompressedTexImage2D(face, level, d.compressedFormat, l.width, l.height, 0, l.size, base + l.offset);
+        }
+        if (target.kind == GL_TEXTURE_2D)
+        {
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, (GLint)d.levels.size() - 1);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        }
+        glBindTexture(target.kind, 0);
+    }
+
+    static std::string cachePath(const std::string& path)
+    {
+        return path + ".ctex";
+    }
+
+    // worker thread: fill d.levels / d.compressed from a valid .ctex
+    static bool readCache(Decoded& d)
+    {
+        MappedFile file;
+        if (!file.Open(cachePath(d.path)))
+            return false;
+
+        const unsigned char* p = file.Data();
+        const unsigned char* end = p + file.Size();
+        CacheHeader header;
+        if (file.Size() < sizeof(header)) return false;
+        std::memcpy(&header, p, sizeof(header));
+        p += sizeof(header);
+        if (header.magic != kCacheMagic || header.version != kCacheVersion || header.sourceHash != d.sourceHash
+            || header.format == 0 || (header.format != d.rgbFormat && header.format != d.rgbaFormat)
+            || header.levelCount == 0 || (size_t)(end - p) < header.levelCount * sizeof(Level))
+            return false;
+
+        d.levels.resize(header.levelCount);
+        std::memcpy(d.levels.data(), p, header.levelCount * sizeof(Level));
+        p += header.levelCount * sizeof(Level);
+        for (const Level& l : d.levels)
+            if ((size_t)(end - p) < (size_t)l.offset + l.size) { d.levels.clear(); return false; }
+
+        d.compressed.assign(p, end);
+        d.compressedFormat = header.format;
+        d.width = d.levels[0].width;
+        d.height = d.levels[0].height;
+        return true;
+    }
+
+    // GL thread, texture bound: read back what the driver encoded and store it
+    void writeCache(const Decoded& d, GLenum format) const
+    {
+        const Target& target = mTargets[d.target];
+        GLenum face = target.kind == GL_TEXTURE_CUBE_MAP ? GL_TEXTURE_CUBE_MAP_POSITIVE_X + d.face : GL_TEXTURE_2D;
+
+        GLint isCompressed = 0;
+        glGetTexLevelParameteriv(face, 0, GL_TEXTURE_COMPRESSED, &isCompressed);
+        if (!isCompressed) return; // the driver kept it uncompressed, nothing to cache
+
+        // the cubemap has no mips; 2D textures keep the full chain glGenerateMipmap built
+        int levelCount = 1;
+        if (target.kind == GL_TEXTURE_2D)
+            while ((std::max(d.width, d.height) >> levelCount) > 0) levelCount++;
+
+        std::vector<Level> levels(levelCount);
+        std::vector<unsigned char> data;
+        for (int level = 0; level < levelCount; level++) {
+            GLint w = 0, h = 0, size = 0;
+            glGetTexLevelParameteriv(face, level, GL_TEXTURE_WIDTH, &w);
+            glGetTexLevelParameteriv(face, level, GL_TEXTURE_HEIGHT, &h);
+            glGetTexLevelParameteriv(face, level, GL_TEXTURE_COMPRESSED_IMAGE_SIZE, &size);
+            if (size <= 0) return;
+
+            levels[level].width = w;
+            levels[level].height = h;
+            levels[level].offset = (uint32_t)data.size();
+            levels[level].size = size;
+            data.resize(data.size() + size);
+            glGetCompressedTexImage(face, level, data.data() + levels[level].offset);
+        }
+
+        // temp file + rename, like the mesh cache
+        const std::string path = cachePath(d.path);
+        const std::string tmpPath = path + ".tmp";
+        {
+            std::ofstream out(tmpPath, std::ios::binary | std::ios::trunc);
+            if (!out) return;
+            CacheHeader header = { kCacheMagic, kCacheVersion, d.sourceHash, format, (uint32_t)levelCount };
+            out.write((const char*)&header, sizeof(header));
+            out.write((const char*)levels.data(), levels.size() * sizeof(Level));
+            out.write((const char*)data.data(), data.size());
+            if (!out) return;
+        }
+        std::remove(path.c_str());
+        std::rename(tmpPath.c_str(), path.c_str());
+    }
+};
+
+#endif
@@ -0,0 +1,51 @@
+#ifndef TRIPLE_BUFFER_H
+#define TRIPLE_BUFFER_H
+
+#include <atomic>
+
+// Lock-free single-producer / single-consumer triple buffer.
+//
+// The producer fills Back() and calls Publish(); the consumer calls Acquire()
+// and reads Front(). Neither side ever waits for the other: the producer always
+// has a slot of its own to write, and the consumer always sees the most recent
+// complete value (intermediate ones are simply dropped). Slots are reused, so
+// a T holding vectors keeps its capacity and stops allocating after warm-up.
+template <typename T>
+class TripleBuffer
+{
+public:
+    TripleBuffer() : mBack(0), mMiddle(1), mFront(2) {}
+
+    TripleBuffer(const TripleBuffer&) = delete;
+    TripleBuffer& operator=(const TripleBuffer&) = delete;
+
+    // producer side
+    T& Back() { return mSlots[mBack]; }
+
+    // hand the back slot over as the newest value and take the spare one back
+    void Publish()
+    {
+        mBack = mMiddle.exchange(mBack | kFresh, std::memory_order_acq_rel) & kIndexMask;
+    }
+
+    // consumer side: true when a newer value than the current Front() was taken
+    bool Acquire()
+    {
+        if (!(mMiddle.load(std::memory_order_relaxed) & kFresh)) return false;
+        mFront = mMiddle.exchange(mFront, std::memory_order_acq_rel) & kIndexMask;
+        return true;
+    }
+
+    const T& Front() const { return mSlots[mFront]; }
+
+private:
+    static const int kIndexMask = 3;
+    static const int kFresh = 4; // set on the middle index by Publish, cleared by Acquire
+
+    T mSlots[3];
+    int mBack;              // producer only
+    std::atomic<int> mMiddle;
+    int mFront;             // consumer only
+};
+
+#endif
@@ -0,0 +1,252 @@
+#ifndef WAV_AUDIO_H
+#define WAV_AUDIO_H
+
+#include "audio.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+// AudioBackend that mixes in software and writes the result to a 16-bit stereo
+// .wav file instead of a sound device. Update(dt) renders exactly dt seconds,
+// so the file lines up with game time rather than wall time. With an empty
+// output path the audio is mixed and thrown away, which is what the benchmark
+// uses to time the mixer on its own.
+//
+// Only uncompressed .wav (8/16-bit PCM or 32-bit float, mono or stereo) can be
+// loaded; anything else (the .mp3 music) fails to load and plays as silence.
+class WavFileAudio : public AudioBackend
+{
+public:
+    static const int kSampleRate = 44100;
+
+    WavFileAudio(const std::string& outPath)
+        : mNextVoice(0), mCarry(0.0), mFramesWritten(0), mPeakVoices(0)
+    {
+        if (outPath.empty()) return;
+        mFile.open(outPath, std::ios::binary);
+        if (!mFile)
+            std::fprintf(stderr, "WavFileAudio: can't write %s\n", outPath.c_str());
+        else
+            writeHeader(); // sizes patched in Close()
+    }
+
+    ~WavFileAudio()
+    {
+        Close();
+    }
+
+    const char* Name() const override { return "wav"; }
+
+    int Load(const std::string& path, bool = false) override
+    {
+        std::ifstream in(path, std::ios::binary);
+        if (!in) return -1;
+        std::vector<char> bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        std::vector<float> samples;
+        if (!decodeWav(bytes, samples)) {
+            std::fprintf(stderr, "WavFileAudio: %s is not an uncompressed .wav\n", path.c_str());
+            return -1;
+        }
+        mClips.push_back(samples);
+        return (int)mClips.size() - 1;
+    }
+
+    // add a clip that is already in memory: interleaved stereo at kSampleRate
+    int LoadSamples(const std::vector<float>& stereo)
+    {
+        mClips.push_back(stereo);
+        return (int)mClips.size() - 1;
+    }
+
+    int Play(int sound, float volume, bool looped = false) override
+    {
+        if (sound < 0 || mClips[sound].empty()) return -1;
+        Voice v;
+        v.id = mNextVoice++;
+        v.clip = sound;
+        v.volume = volume;
+        v.looped = looped;
+        mVoices.push_back(v);
+        mPeakVoices = std::max(mPeakVoices, (int)mVoices.size());
+        return v.id;
+    }
+
+    bool IsPlaying(int voice) override
+    {
+        return findVoice(voice) != mVoices.end();
+    }
+
+    void Stop(int voice) override
+    {
+        auto it = findVoice(voice);
+        if (it != mVoices.end()) mVoices.erase(it);
+    }
+
+    void Update(float dt) override
+    {
+        mCarry += (double)dt * kSampleRate;
+        int frames = (int)mCarry;
+        mCarry -= frames;
+        if (frames <= 0) return;
+
+        mMix.assign((size_t)frames * 2, 0.0f);
+        for (int v = (int)mVoices.size() - 1; v >= 0; --v) {
+            Voice& voice = mVoices[v];
+            const std::vector<float>& clip = mClips[voice.clip];
+            size_t length = clip.size();
+            size_t out = 0, total = mMix.size();
+            while (out < total) {
+                size_t n = std::min(total - out, length - voice.cursor);
+                const float* src = clip.data() + voice.cursor;
+                float* dst = mMix.data() + out;
+                for (size_t i = 0; i < n; ++i)
+                    dst[i] += src[i] * voice.volume;
+                out += n;
+                voice.cursor += n;
+                if (voice.cursor < length) continue;
+                if (!voice.looped) break;
+                voice.cursor = 0;
+            }
+            if (voice.cursor >= length && !voice.looped)
+                mVoices.erase(mVoices.begin() + v);
+        }
+
+        mFramesWritten += frames;
+        if (!mFile.is_open()) return;
+        mPcm.resize(mMix.size());
+        for (size_t i = 0; i < mMix.size(); ++i)
+            mPcm[i] = (int16_t)(std::max(-1.0f, std::min(1.0f, mMix[i])) * 32767.0f);
+        mFile.write((const char*)mPcm.data(), mPcm.size() * sizeof(int16_t));
+    }
+
+    // finish the file; called by the destructor, safe to call twice
+    void Close()
+    {
+        if (!mFile.is_open()) return;
+        mFile.seekp(0);
+        writeHeader();
+        mFile.close();
+    }
+
+    double SecondsMixed() const { return (double)mFramesWritten / kSampleRate; }
+    int ActiveVoices() const { return (int)mVoices.size(); }
+    int PeakVoices() const { return mPeakVoices; }
+
+private:
+    struct Voice {
+        int id = 0;
+        int clip = 0;
+        size_t cursor = 0; // in floats, always even
+        float volume = 1.0f;
+        bool looped = false;
+    };
+
+    std::vector<std::vector<float>> mClips; // interleaved stereo at kSampleRate
+    std::vector<Voice> mVoices;
+    int mNextVoice;
+    double mCarry;         // fraction of a frame left over from the last Update()
+    int64_t mFramesWritten;
+    int mPeakVoices;
+    std::vector<float> mMix;
+    std::vector<int16_t> mPcm;
+    std::ofstream mFile;
+
+    std::vector<Voice>::iterator findVoice(int id)
+    {
+        return std::find_if(mVoices.begin(), mVoices.end(), [id](const Voice& v) { return v.id == id; });
+    }
+
+    void writeHeader()
+    {
+        uint32_t dataBytes = (uint32_t)(mFramesWritten * 4);
+        uint32_t riffBytes = 36 + dataBytes;
+        uint32_t fmtBytes = 16, rate = kSampleRate, byteRate = kSampleRate * 4;
+        uint16_t format = 1, channels = 2, blockAlign = 4, bits = 16;
+        mFile.write("RIFF", 4);
+        mFile.write((const char*)&riffBytes, 4);
+        mFile.write("WAVEfmt ", 8);
+        mFile.write((const char*)&fmtBytes, 4);
+        mFile.write((const char*)&format, 2);
+        mFile.write((const char*)&channels, 2);
+        mFile.write((const char*)&rate, 4);
+        mFile.write((const char*)&byteRate, 4);
+        mFile.write((const char*)&blockAlign, 2);
+        mFile.write((const char*)&bits, 2);
+        mFile.write("data", 4);
+        mFile.write((const char*)&dataBytes, 4);
+    }
+
+    static uint32_t readU32(const char* p) { uint32_t v; std::memcpy(&v, p, 4); return v; }
+    static uint16_t readU16(const char* p) { uint16_t v; std::memcpy(&v, p, 2); return v; }
+
+    // little-endian RIFF/WAVE -> interleaved stereo floats at kSampleRate
+    static bool decodeWav(const std::vector<char>& bytes, std::vector<float>& out)
+    {
+        if (bytes.size() < 12 || std::memcmp(bytes.data(), "RIFF", 4) || std::memcmp(bytes.data() + 8, "WAVE", 4))
+            return false;
+
+        int format = 0, channels = 0, rate = 0, bits = 0;
+        const char* data = nullptr;
+        size_t dataBytes = 0;
+        for (size_t at = 12; at + 8 <= bytes.size();) {
+            const char* chunk = bytes.data() + at;
+            size_t size = std::min<size_t>(readU32(chunk + 4), bytes.size() - at - 8);
+            if (!std::memcmp(chunk, "fmt ", 4) && size >= 16) {
+                format = readU16(chunk + 8);
+                channels = readU16(chunk + 10);
+                rate = (int)readU32(chunk + 12);
+                bits = readU16(chunk + 22);
+                if (format == 0xFFFE && size >= 40) format = readU16(chunk + 32); // WAVE_FORMAT_EXTENSIBLE
+            } else if (!std::memcmp(chunk, "data", 4)) {
+                data = chunk + 8;
+                dataBytes = size;
+            }
+            at += 8 + size + (size & 1);
+        }
+
+        bool pcm = format == 1 && (bits == 8 || bits == 16);
+        bool flt = format == 3 && bits == 32;
+        if (!data || (!pcm && !flt) || channels < 1 || channels > 2 || rate <= 0)
+            return false;
+
+        int frameBytes = channels * bits / 8;
+        size_t frames = dataBytes / frameBytes;
+        std::vector<float> src(frames * 2);
+        for (size_t f = 0; f < frames; ++f) {
+            for (int c = 0; c < 2; ++c) {
+                const char* s = data + f * frameBytes + (c % channels) * (bits / 8);
+                float v;
+                if (bits == 8) v = ((uint8_t)*s - 128) / 128.0f;
+                else if (bits == 16) v = (int16_t)readU16(s) / 32768.0f;
+                else std::memcpy(&v, s, 4);
+                src[f * 2 + c] = v;
+            }
+        }
+
+        if (rate == kSampleRate) {
+            out.swap(src);
+            return true;
+        }
+        // linear resample, done once at load so mixing is a plain add
+        size_t outFrames = (size_t)((double)frames * kSampleRate / rate);
+        out.resize(outFrames * 2);
+        double stepIn = (double)rate / kSampleRate;
+        for (size_t f = 0; f < outFrames; ++f) {
+            double pos = f * stepIn;
+            size_t i = (size_t)pos;
+            size_t j = std::min(i + 1, frames - 1);
+            float t = (float)(pos - i);
+            for (int c = 0; c < 2; ++c)
+                out[f * 2 + c] = src[i * 2 + c] + (src[j * 2 + c] - src[i * 2 + c]) * t;
+        }
+        return true;
+    }
+};
+
+#endif
@@ -0,0 +1,423 @@
+#ifndef WORLD_H
+#define WORLD_H
+
+#include <glm/glm.hpp>
+
+#include "bullet_pool.h"
+#include "enemy_pool.h"
+#include "job_system.h"
+#include "random.h"
+#include "simd_kernels.h"
+#include "spatial_hash.h"
+#include "swept.h"
+
+#include <atomic>
+#include <cfloat>
+#include <vector>
+#include <cstdint>
+#include <cmath>
+#include <algorithm>
+
+// Headless game simulation: bullets, enemies, collisions and timers.
+// Nothing in here may touch GL, GLFW or irrKlang so it can be stepped from a
+// benchmark or test driver without a window. Side effects the frontend cares
+// about (sounds, score popups) are reported back through StepEvents.
+// All randomness comes from the world's own Rng, so a given seed plus the
+// sequence of Step() inputs fully determines the game (see replay.h).
+// With a JobSystem attached the per-entity phases of Step() run in parallel;
+// anything order-dependent (score, HP, respawns, which draw from Rng) is then
+// applied serially in index order, so results don't depend on the thread count.
+// Enemies and bullets are structure-of-arrays; the movement, culling and
+// distance loops are the SIMD kernels from simd_kernels.h.
+
+// enemy hit flash
+const float kFlashDur = 0.12f;
+const float kFlashBoost = 1.2f;
+const float kDeathDur = 0.35f;
+// player hit flash
+const float kPlayerFlashDur = 1.0f;
+const float kPlayerFlashBoost = 2.0f;
+
+const float playerMaxHealth = 100.0f;
+
+// collision radii, compared squared
+const float kBulletHitRadius = 0.5f;  // bullet vs ship
+const float kShipHitRadius = 0.7f;    // enemy ship vs player
+
+// player bullets further than this from the player are dropped (enemies spawn at most ~30 away)
+const float kPlayerBulletRange = 60.0f;
+
+// smallest slice of a parallel phase worth handing to another thread
+const int kEnemyGrain = 1024;
+const int kBulletGrain = 2048;
+
+// per-tick player input, already resolved from whatever device produced it
+struct PlayerInput {
+    glm::vec2 move = glm::vec2(0.0f); // x: left/right, y: down/up, each in [-1, 1]
+    glm::vec3 aim = glm::vec3(0.0f, 0.0f, -1.0f);
+};
+
+// what happened during a single Step(), for the frontend to react to
+struct StepEvents {
+    int enemiesHit = 0;
+    int playerHits = 0;
+};
+
+inline float randomFloat(Pcg32& rng, float min, float max) {
+    return rng.Range(min, max);
+}
+
+inline glm::vec3 hsv2rgb(float h, float s, float v)
+{
+    float c = v * s;
+    float x = c * (1.0f - fabsf(fmodf(h / 60.0f, 2.0f) - 1.0f));
+    float m = v - c;
+
+    float r, g, b;
+    if (h < 60.0f) { r = c; g = x; b = 0.0f; }
+    else if (h < 120.0f) { r = x; g = c; b = 0.0f; }
+    else if (h < 180.0f) { r = 0.0f; g = c; b = x; }
+    else if (h < 240.0f) { r = 0.0f; g = x; b = c; }
+    else if (h < 300.0f) { r = x; g = 0.0f; b = c; }
+    else { r = c; g = 0.0f; b = x; }
+
+    return glm::vec3(r + m, g + m, b + m);
+}
+
+inline glm::vec3 randomBrightColor(Pcg32& rng)
+{
+    float h = randomFloat(rng, 0.0f, 360.0f);
+    float s = 0.9f;
+    float v = 1.0f;
+    return hsv2rgb(h, s, v);
+}
+
+class World
+{
+public:
+    // player
+    glm::vec3 PlayerPosition;
+    glm::vec3 PrevPlayerPosition; // at the start of the last Step(), for interpolation
+    float PlayerSpeed = 3.0f;
+    float PlayerHealth;
+    int   PlayerScore;
+    float PlayerFlashT;
+
+    // entities
+    BulletPool Bullets;
+    BulletPool EnemyBullets;
+    EnemyPool Enemies;
+
+    // tuning
+    float ShootCooldown = 0.25f;
+    float EnemyShootCooldown = 1.5f;
+    float EnemyStepDown = 0.05f;
+
+    // simulated time in seconds, only advances in Step()
+    double Time = 0.0;
+
+    // spawn positions, colors and shooter choice
+    Pcg32 Rng;
+
+    World(int enemyCount = 15, int bulletCapacity = kDefaultBulletCapacity, uint64_t seed = Pcg32::kDefaultSeed)
+        : Bullets(bulletCapacity), EnemyBullets(bulletCapacity), Rng(seed)
+    {
+        Enemies.Resize(enemyCount);
+        Reset();
+    }
+
+    // run Step()'s per-entity phases on jobs (null = single-threaded); not owned
+    void SetJobSystem(JobSystem* jobs)
+    {
+        mJobs = jobs;
+    }
+
+    // restart the random sequence; takes effect from the next Reset() / spawn
+    void Seed(uint64_t seed)
+    {
+        Rng.Seed(seed);
+    }
+
+    // put the player, bullets, enemies and timers back to a fresh game
+    void Reset()
+    {
+        PlayerHealth = playerMaxHealth;
+        PlayerScore = 0;
+        PlayerPosition = glm::vec3(0.0f, -0.8f, 3.0f);
+        PrevPlayerPosition = PlayerPosition;
+        PlayerFlashT = 0.0f;
+
+        Bullets.Clear();
+        EnemyBullets.Clear();
+
+        for (int i = 0; i < Enemies.Size(); ++i) {
+            RespawnEnemy(i);
+        }
+
+        mTimeSinceLastShot = 0.0f;
+        mTimeSinceLastEnemyShot = 0.0f;
+        mMoveRight = true;
+    }
+
+    void RespawnEnemy(int i)
+    {
+        float x = randomFloat(Rng, -4.0f, 4.0f);
+        float y = randomFloat(Rng, 2.0f, 6.0f);
+        float z = randomFloat(Rng, -30.0f, -15.0f);
+
+        Enemies.PosX[i] = Enemies.PrevX[i] = x; // no interpolation across a respawn
+        Enemies.PosY[i] = Enemies.PrevY[i] = y;
+        Enemies.PosZ[i] = Enemies.PrevZ[i] = z;
+        Enemies.State[i] = ENEMY_ALIVE;
+        Enemies.DeathT[i] = 0.0f;
+        Enemies.FlashT[i] = 0.0f;
+        Enemies.Color[i] = randomBrightColor(Rng);
+    }
+
+    bool IsPlayerDead() const
+    {
+        return PlayerHealth <= 0.0f;
+    }
+
+    // render-side blend between the previous and the current tick, alpha in [0, 1]
+    glm::vec3 InterpolatedPlayer(float alpha) const
+    {
+        return glm::mix(PrevPlayerPosition, PlayerPosition, alpha);
+    }
+
+    // advance the whole game by dt seconds
+    StepEvents Step(float dt, const PlayerInput& input)
+    {
+        StepEvents events;
+        Time += dt;
+
+        PrevPlayerPosition = PlayerPosition;
+        const int enemyCount = Enemies.Size();
+
+        movePlayer(dt, input);
+
+        mTimeSinceLastShot += dt;
+        mTimeSinceLastEnemyShot += dt;
+
+        // ---- player bullets spawn + movement ----
+        if (mTimeSinceLastShot >= ShootCooldown)
+        {
+            Bullets.Spawn(PlayerPosition + glm::vec3(0.0f, 0.2f, 0.0f), glm::normalize(input.aim), 10.0f);
+            mTimeSinceLastShot = 0.0f;
+        }
+
+        // culled above y = 5 or out of range in any direction, so a forward aim can't fill the pool
+        mCull.resize(Bullets.Size());
+        mInRange.resize(Bullets.Size());
+        parallelFor(mJobs, Bullets.Size(), kBulletGrain, [&](int begin, int end) {
+            Bullets.Advance(begin, end, dt);
+            outsideRange(Bullets.PosY.data(), begin, end, -FLT_MAX, 5.0f, mCull.data());
+            withinRadius(Bullets.PosX.data(), Bullets.PosY.data(), Bullets.PosZ.data(), begin, end,
+                         PlayerPosition, kPlayerBulletRange * kPlayerBulletRange, mInRange.data());
+        });
+        // backwards, so swap-and-pop only ever moves an already-handled bullet into slot i
+        for (int i = Bullets.Size() - 1; i >= 0; --i)
+        {
+            if (mCull[i] || !mInRange[i])
+                Bullets.Kill(i);
+        }
+
+        // ---- enemy bullets update + hit player ----
+        // swept over the tick in the player's frame (the player has already moved this step)
+        mHits.resize(EnemyBullets.Size());
+        mCull.resize(EnemyBullets.Size());
+        parallelFor(mJobs, EnemyBullets.Size(), kBulletGrain, [&](int begin, int end) {
+            EnemyBullets.Advance(begin, end, dt);
+            sweptSphereBatch(&EnemyBullets.PrevX[begin], &EnemyBullets.PrevY[begin], &EnemyBullets.PrevZ[begin],
+                             &EnemyBullets.PosX[begin], &EnemyBullets.PosY[begin], &EnemyBullets.PosZ[begin],
+                             end - begin, PrevPlayerPosition, PlayerPosition, kBulletHitRadius, &mHits[begin]);
+            outsideRange(EnemyBullets.PosZ.data(), begin, end, -60.0f, 10.0f, mCull.data());
+        });
+        for (int i = EnemyBullets.Size() - 1; i >= 0; --i)
+        {
+            if (mHits[i]) {
+                events.playerHits++;
+                damagePlayer(10.0f);
+                EnemyBullets.Kill(i);
+            }
+            else if (mCull[i]) {
+                EnemyBullets.Kill(i);
+            }
+        }
+
+        // ---- player bullets hit enemies (a bullet is used up by the first enemy it touches) ----
+        mEnemyGrid.Clear();
+        for (int j = 0; j < enemyCount; ++j) {
+            if (Enemies.Alive(j))
+                mEnemyGrid.Insert(j, Enemies.Position(j));
+        }
+        mEnemyGrid.Build();
+
+        // which enemy each bullet hits only depends on positions, so it's found in parallel
+        mBulletHit.resize(Bullets.Size());
+        parallelFor(mJobs, Bullets.Size(), kBulletGrain, [&](int begin, int end) {
+            for (int i = begin; i < end; ++i) {
+                // the segment the bullet covered this tick; enemies haven't moved yet
+                glm::vec3 from = Bullets.PrevPosition(i);
+                glm::vec3 to = Bullets.Position(i);
+                glm::vec3 lo = glm::min(from, to) - glm::vec3(kBulletHitRadius);
+                glm::vec3 hi = glm::max(from, to) + glm::vec3(kBulletHitRadius);
+
+                // the enemy the bullet reaches first wins, lowest index on a tie
+                int hit = -1;
+                float hitT = 2.0f;
+                mEnemyGrid.ForEachInBox(lo, hi, [&](int j) {
+                    float t;
+                    if (!segmentSphere(from, to, Enemies.Position(j), kBulletHitRadius, t)) return;
+                    if (t < hitT || (t == hitT && j < hit)) { hit = j; hitT = t; }
+                });
+                mBulletHit[i] = hit;
+            }
+        });
+
+        // ...and applied in bullet order
+        for (int i = 0; i < Bullets.Size(); ) {
+            int hit = mBulletHit[i];
+            if (hit != -1) {
+                if (Enemies.State[hit] == ENEMY_ALIVE) {
+                    Enemies.State[hit] = ENEMY_DYING;
+                    Enemies.DeathT[hit] = 0.0f;
+                    Enemies.FlashT[hit] = kFlashDur;
+                    events.enemiesHit++;
+                    PlayerScore += 5;
+                }
+                // the last bullet moves into slot i, and its result with it
+                mBulletHit[i] = mBulletHit[Bullets.Size() - 1];
+                Bullets.Kill(i);
+            }
+            else {
+                i++;
+            }
+        }
+
+        // ---- Enemy movement ----
+        float leftLimit = -5.0f;
+        float rightLimit = 5.0f;
+        float moveSpeed = 2.5f;
+        glm::vec3 moveDir = glm::normalize(glm::vec3(0.0f, -0.3f, 1.0f));
+        glm::vec3 moveStep = moveDir * moveSpeed * dt;
+        // sway is sin(Time + z); Time is folded into one period first so the float argument stays small
+        float swayPhase = (float)std::fmod(Time, 6.283185307179586);
+
+        // respawns draw from Rng, so they're only flagged here and done in index order below.
+        // Dead enemies move along with the rest; they are respawned anyway.
+        mFlags.resize(enemyCount);
+        parallelFor(mJobs, enemyCount, kEnemyGrain, [&](int begin, int end) {
+            integrateEnemies(Enemies.PosX.data(), Enemies.PosY.data(), Enemies.PosZ.data(),
+                             Enemies.PrevX.data(), Enemies.PrevY.data(), Enemies.PrevZ.data(),
+                             begin, end, moveStep, swayPhase, 0.002f);
+            outsideRange(Enemies.PosZ.data(), begin, end, -FLT_MAX, PlayerPosition.z + 1.0f, mFlags.data());
+            for (int j = begin; j < end; ++j)
+                mFlags[j] |= (uint8_t)(Enemies.State[j] == ENEMY_DEAD);
+        });
+        for (int j = 0; j < enemyCount; ++j) {
+            if (mFlags[j]) RespawnEnemy(j);
+        }
+        // from here until the timers below no enemy is ENEMY_DEAD
+
+        // ---- Enemy shooting ----
+        if (mTimeSinceLastEnemyShot >= EnemyShootCooldown) {
+            mAliveIndices.clear();
+            for (int i = 0; i < enemyCount; ++i) {
+                if (Enemies.State[i] == ENEMY_ALIVE) {
+                    mAliveIndices.push_back(i);
+                }
+            }
+
+            if (!mAliveIndices.empty()) {
+                int idx = mAliveIndices[Rng.Below((uint32_t)mAliveIndices.size())];
+                glm::vec3 shooter = Enemies.Position(idx);
+
+                EnemyBullets.Spawn(shooter, glm::normalize(PlayerPosition - shooter), 8.0f);
+            }
+
+            mTimeSinceLastEnemyShot = 0.0f;
+        }
+
+        // ---- Enemy-player collision ----
+        parallelFor(mJobs, enemyCount, kEnemyGrain, [&](int begin, int end) {
+            withinRadius(Enemies.PosX.data(), Enemies.PosY.data(), Enemies.PosZ.data(), begin, end,
+                         PlayerPosition, kShipHitRadius * kShipHitRadius, mFlags.data());
+        });
+        for (int j = 0; j < enemyCount; ++j) {
+            if (!mFlags[j]) continue;
+            events.playerHits++;
+            damagePlayer(20.0f);
+            RespawnEnemy(j);
+        }
+
+        // ---- Edge bounce ----
+        // any enemy past the edge the wave is heading for
+        std::atomic<bool> bounce(false);
+        float edgeLo = mMoveRight ? -FLT_MAX : leftLimit;
+        float edgeHi = mMoveRight ? rightLimit : FLT_MAX;
+        parallelFor(mJobs, enemyCount, kEnemyGrain, [&](int begin, int end) {
+            if (outsideRange(Enemies.PosX.data(), begin, end, edgeLo, edgeHi, mFlags.data()) > 0)
+                bounce.store(true, std::memory_order_relaxed);
+        });
+
+        // ---- Flash / death timers (and the bounce step-down) ----
+        bool stepDown = bounce.load();
+        if (stepDown) mMoveRight = !mMoveRight;
+        parallelFor(mJobs, enemyCount, kEnemyGrain, [&](int begin, int end) {
+            for (int j = begin; j < end; ++j) {
+                if (stepDown) {
+                    Enemies.PosY[j] -= EnemyStepDown;
+                }
+                if (Enemies.FlashT[j] > 0.0f) {
+                    Enemies.FlashT[j] = std::max(0.0f, Enemies.FlashT[j] - dt);
+                }
+                if (Enemies.State[j] == ENEMY_DYING) {
+                    Enemies.DeathT[j] += dt;
+                    if (Enemies.DeathT[j] >= kDeathDur) {
+                        Enemies.State[j] = ENEMY_DEAD;
+                    }
+                }
+            }
+        });
+
+        if (PlayerFlashT > 0.0f) {
+            PlayerFlashT = std::max(0.0f, PlayerFlashT - dt);
+        }
+        if (PlayerHealth < 0.0f) PlayerHealth = 0.0f;
+
+        return events;
+    }
+
+private:
+    float mTimeSinceLastShot = 0.0f;
+    float mTimeSinceLastEnemyShot = 0.0f;
+    bool mMoveRight = true;
+    std::vector<int> mAliveIndices; // scratch, kept to avoid a per-shot allocation
+    std::vector<uint8_t> mHits;     // scratch, per enemy bullet
+    std::vector<uint8_t> mCull;     // scratch, per bullet that left the playfield
+    std::vector<uint8_t> mInRange;  // scratch, per player bullet still near the player
+    std::vector<int> mBulletHit;    // scratch, enemy hit by each player bullet or -1
+    std::vector<uint8_t> mFlags;    // scratch, per enemy (respawn / rammed the player)
+    JobSystem* mJobs = nullptr;
+    SpatialHash mEnemyGrid{ 2.0f * kBulletHitRadius };
+
+    void movePlayer(float dt, const PlayerInput& input)
+    {
+        PlayerPosition.x += input.move.x * PlayerSpeed * dt;
+        PlayerPosition.y += input.move.y * PlayerSpeed * dt;
+
+        // Clamp player within screen limits for X and Y
+        PlayerPosition.x = glm::clamp(PlayerPosition.x, -4.0f, 4.0f); // horizontal limits
+        PlayerPosition.y = glm::clamp(PlayerPosition.y, -5.0f, 1.0f); // vertical limits
+    }
+
+    void damagePlayer(float amount)
+    {
+        PlayerFlashT = kPlayerFlashDur;
+        PlayerHealth -= amount;
+        if (PlayerHealth < 0.0f) PlayerHealth = 0.0f;
+    }
+};
+
+#endif